@@ -0,0 +1,94 @@
+/*
+ * Load and lookup times for one section of 10, 1k and 100k keys. Built twice by the Makefile: bench_index
+ * uses the key index, bench_index_linear raises ZINI_PAIR_INDEX_THRESHOLD so every section keeps the
+ * linear scan all lookups went through before the index.
+ */
+#ifndef _POSIX_C_SOURCE
+    #define _POSIX_C_SOURCE 200809L
+#endif // _POSIX_C_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "zini.h"
+
+#define LOOKUPS 10000
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static char* build_source(size_t keys, size_t* length) {
+    size_t capacity = 16 + keys * 32;
+    char* data = (char*)malloc(capacity);
+    if (!data) return NULL;
+    size_t used = (size_t)snprintf(data, capacity, "[bench]\n");
+    for (size_t i = 0; i < keys; i++) {
+        used += (size_t)snprintf(data + used, capacity - used, "key%zu=%zu\n", i, i * 7);
+    }
+    *length = used;
+    return data;
+}
+
+static bool run(size_t keys) {
+    size_t length;
+    char* data = build_source(keys, &length);
+    if (!data) return false;
+
+    // parsing, every key goes through the duplicate check
+    INIFILE iniFile;
+    double start = now();
+    bool opened = ZINI_OpenBuffer(&iniFile, data, length);
+    double parse = now() - start;
+    free(data);
+    if (!opened) return false;
+
+    // building through the public API, as callers without a file do
+    INIFILE built;
+    ZINI_Init(&built);
+    char key[32];
+    char value[32];
+    start = now();
+    Section* section = ZINI_AddSection(&built, "bench");
+    for (size_t i = 0; i < keys; i++) {
+        snprintf(key, sizeof(key), "key%zu", i);
+        snprintf(value, sizeof(value), "%zu", i * 7);
+        ZINI_AddPair(section, key, value);
+    }
+    double add = now() - start;
+
+    // lookups spread over the whole section, found and missing keys alike
+    section = ZINI_FindSection(&iniFile, "bench");
+    size_t found = 0;
+    unsigned state = 12345;
+    start = now();
+    for (size_t i = 0; i < LOOKUPS; i++) {
+        state = state * 1103515245u + 12345u;
+        snprintf(key, sizeof(key), "key%zu", (size_t)(state >> 8) % (keys + keys / 4 + 1));
+        found += ZINI_KeyExists(section, key);
+    }
+    double lookup = now() - start;
+
+    printf("%8zu keys  parse %10.3f ms  add %10.3f ms  lookup %8.1f ns  (%zu found)\n",
+           keys, parse * 1e3, add * 1e3, lookup * 1e9 / LOOKUPS, found);
+
+    built.isModified = false; // nothing to save, ZINI_Clean would warn about it
+    ZINI_Clean(&built);
+    ZINI_Clean(&iniFile);
+    return true;
+}
+
+int main(void) {
+    static const size_t sizes[] = {10, 1000, 100000};
+    printf("%s\n", ZINI_PAIR_INDEX_THRESHOLD >= (size_t)-1 ? "linear scan" : "key index");
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        if (!run(sizes[i])) {
+            fprintf(stderr, "benchmark for %zu keys failed\n", sizes[i]);
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
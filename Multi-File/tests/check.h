@@ -0,0 +1,96 @@
+#ifndef ZINI_CHECK_H
+#define ZINI_CHECK_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "zini.h"
+
+// counts failed checks, a test program exits with a failure status if any failed
+static int checkFailures = 0;
+
+#define CHECK(condition) do { \
+    if (!(condition)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+        checkFailures++; \
+    } \
+} while (0)
+
+// NULL and "" are different answers, so both sides must be NULL or hold the same string
+#define CHECK_SAME_VALUE(a, b) do { \
+    const char* checkA = (a); \
+    const char* checkB = (b); \
+    if ((checkA == NULL) != (checkB == NULL) || (checkA && strcmp(checkA, checkB) != 0)) { \
+        fprintf(stderr, "%s:%d: values differ: \"%s\" and \"%s\"\n", __FILE__, __LINE__, \
+                checkA ? checkA : "(null)", checkB ? checkB : "(null)"); \
+        checkFailures++; \
+    } \
+} while (0)
+
+static inline int check_result(const char* name) {
+    if (checkFailures) fprintf(stderr, "%s: %d checks failed\n", name, checkFailures);
+    else printf("%s: ok\n", name);
+    return checkFailures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// writes data to a new temporary file, path must hold a mkstemp template
+static inline bool check_write_file(char* path, const char* data, size_t length) {
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        perror("mkstemp");
+        return false;
+    }
+    bool written = write(fd, data, length) == (ssize_t)length;
+    close(fd);
+    return written;
+}
+
+// reads a whole file into a NUL-terminated buffer the caller frees
+static inline char* check_read_file(const char* path, size_t* length) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* data = (char*)malloc((size_t)size + 1);
+    if (data && fread(data, 1, (size_t)size, file) != (size_t)size) {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+    if (data) {
+        data[size] = '\0';
+        if (length) *length = (size_t)size;
+    }
+    return data;
+}
+
+// true if both files hold the same sections with the same pairs, in the same order
+static inline bool check_same_contents(const INIFILE* a, const INIFILE* b) {
+    if (a->sectionCount != b->sectionCount) {
+        fprintf(stderr, "section counts differ: %zu and %zu\n", a->sectionCount, b->sectionCount);
+        return false;
+    }
+    for (size_t i = 0; i < a->sectionCount; i++) {
+        const Section* x = &a->sections[i];
+        const Section* y = &b->sections[i];
+        if (strcmp(x->section, y->section) != 0 || x->pairCount != y->pairCount) {
+            fprintf(stderr, "section %zu differs: [%s] with %zu pairs and [%s] with %zu pairs\n",
+                    i, x->section, x->pairCount, y->section, y->pairCount);
+            return false;
+        }
+        for (size_t j = 0; j < x->pairCount; j++) {
+            if (strcmp(x->pairs[j].key, y->pairs[j].key) != 0 || strcmp(x->pairs[j].value, y->pairs[j].value) != 0) {
+                fprintf(stderr, "pair %zu of [%s] differs: %s=%s and %s=%s\n", j, x->section,
+                        x->pairs[j].key, x->pairs[j].value, y->pairs[j].key, y->pairs[j].value);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+#endif // ZINI_CHECK_H
@@ -0,0 +1,101 @@
+/*
+ * ZINI_SaveAtomic and ZINI_SaveAtomicBatch: targets load back as saved and keep their permissions, no temp
+ * files are left behind, and a batch that cannot write every file replaces none of them.
+ */
+#ifndef _POSIX_C_SOURCE
+    #define _POSIX_C_SOURCE 200809L
+#endif // _POSIX_C_SOURCE
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "check.h"
+
+static size_t count_entries(const char* directory) {
+    DIR* dir = opendir(directory);
+    if (!dir) return 0;
+    size_t count = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir))) count += entry->d_name[0] != '.';
+    closedir(dir);
+    return count;
+}
+
+static void check_loads_as(const char* path, const INIFILE* expected) {
+    INIFILE loaded;
+    CHECK(ZINI_Open(&loaded, path));
+    if (!check_same_contents(expected, &loaded)) {
+        fprintf(stderr, "%s does not load back as saved\n", path);
+        checkFailures++;
+    }
+    ZINI_Clean(&loaded);
+}
+
+int main(void) {
+    char first[] = "/tmp/zini_atomic_XXXXXX";
+    char second[] = "/tmp/zini_atomic_XXXXXX";
+    CHECK(mkdtemp(first) && mkdtemp(second));
+
+    char pathA[64], pathB[64], pathC[64], missing[80];
+    snprintf(pathA, sizeof(pathA), "%s/a.ini", first);
+    snprintf(pathB, sizeof(pathB), "%s/b.ini", first);
+    snprintf(pathC, sizeof(pathC), "%s/c.ini", second);
+    snprintf(missing, sizeof(missing), "%s/no such directory/d.ini", second);
+
+    INIFILE a, b, c;
+    CHECK(ZINI_OpenString(&a, "[a]\nkey=1\n"));
+    CHECK(ZINI_OpenString(&b, "[b]\nkey=2\nother=x\n"));
+    CHECK(ZINI_OpenString(&c, "[c]\nkey=3\n"));
+
+    // a new file, then a replacement that keeps the permissions of the one it replaces
+    CHECK(ZINI_SaveAtomic(&a, pathA));
+    check_loads_as(pathA, &a);
+    CHECK(chmod(pathA, 0600) == 0);
+    CHECK(ZINI_SetValueEx(&a, "a", "key", "changed") == ZINI_SUCCESS);
+    CHECK(ZINI_SaveAtomic(&a, pathA));
+    CHECK(!a.isModified);
+    check_loads_as(pathA, &a);
+    struct stat info;
+    CHECK(stat(pathA, &info) == 0 && (info.st_mode & 07777) == 0600);
+
+    // a batch over two directories, one of them holding two of the files
+    INIFILE* files[] = {&a, &b, &c};
+    const char* paths[] = {pathA, pathB, pathC};
+    CHECK(ZINI_AddPairEx(&a, "a", "batch", "yes") != NULL);
+    CHECK(ZINI_SaveAtomicBatch(files, paths, 3));
+    for (size_t i = 0; i < 3; i++) check_loads_as(paths[i], files[i]);
+    CHECK(count_entries(first) == 2);
+    CHECK(count_entries(second) == 1);
+
+    // the last target cannot be written, so the first keeps its old contents and no temp file stays behind
+    INIFILE before;
+    CHECK(ZINI_Clone(&a, &before));
+    CHECK(ZINI_SetValueEx(&a, "a", "key", "never saved") == ZINI_SUCCESS);
+    const char* failing[] = {pathA, missing};
+    CHECK(!ZINI_SaveAtomicBatch(files, failing, 2));
+    check_loads_as(pathA, &before);
+    CHECK(count_entries(first) == 2);
+    CHECK(count_entries(second) == 1);
+
+    // a bare file name is renamed in, and synced through, the current directory
+    char cwd[4096];
+    CHECK(getcwd(cwd, sizeof(cwd)) != NULL);
+    CHECK(chdir(second) == 0);
+    CHECK(ZINI_SaveAtomic(&c, "bare.ini"));
+    check_loads_as("bare.ini", &c);
+    unlink("bare.ini");
+    CHECK(chdir(cwd) == 0);
+
+    a.isModified = false;
+    before.isModified = false;
+    ZINI_Clean(&before);
+    ZINI_Clean(&a);
+    ZINI_Clean(&b);
+    ZINI_Clean(&c);
+    unlink(pathA);
+    unlink(pathB);
+    unlink(pathC);
+    rmdir(first);
+    rmdir(second);
+    return check_result("test_atomic");
+}
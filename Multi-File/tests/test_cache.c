@@ -0,0 +1,78 @@
+/*
+ * The typed value cache of a pair: filled by the first successful typed read, served on repeated reads,
+ * replaced when another type is read, and dropped whenever the value changes.
+ */
+#ifndef _POSIX_C_SOURCE
+    #define _POSIX_C_SOURCE 200809L
+#endif // _POSIX_C_SOURCE
+
+#include "check.h"
+
+int main(void) {
+    INIFILE iniFile;
+    CHECK(ZINI_OpenString(&iniFile, "[s]\nfirst=1\ncount=42\nratio=0.25\nflag=on\nword=abc\n"));
+    Section* section = ZINI_FindSection(&iniFile, "s");
+    Pair* count = &section->pairs[1];
+
+    // nothing is cached by loading, the first read fills the cache and later reads are served from it
+    CHECK(count->cacheType == ZINI_CACHE_NONE);
+    int64_t number = 0;
+    CHECK(ZINI_GetInt64(section, "count", &number) == ZINI_SUCCESS && number == 42);
+    CHECK(count->cacheType == ZINI_CACHE_INT && count->cache.asInt == 42);
+    count->cache.asInt = 7; // only a read from the cache can see this
+    CHECK(ZINI_GetInt64(section, "count", &number) == ZINI_SUCCESS && number == 7);
+    int small = 0;
+    unsigned int positive = 0;
+    CHECK(ZINI_GetInt(section, "count", &small) == ZINI_SUCCESS && small == 7);
+    CHECK(ZINI_GetUInt(section, "count", &positive) == ZINI_SUCCESS && positive == 7);
+
+    // a change drops the cache, through every setter
+    CHECK(ZINI_SetValue(section, "count", "43") == ZINI_SUCCESS);
+    CHECK(count->cacheType == ZINI_CACHE_NONE);
+    CHECK(ZINI_GetInt64(section, "count", &number) == ZINI_SUCCESS && number == 43);
+    CHECK(ZINI_SetValueEx(&iniFile, "s", "count", "-5") == ZINI_SUCCESS);
+    CHECK(ZINI_GetInt64(section, "count", &number) == ZINI_SUCCESS && number == -5);
+    CHECK(ZINI_GetUInt(section, "count", &positive) == ZINI_RANGE_ERROR && positive == 7);
+
+    // reading another type parses the text again and caches that type instead
+    double real = 0;
+    CHECK(ZINI_GetDouble(section, "count", &real) == ZINI_SUCCESS && real == -5.0);
+    CHECK(count->cacheType == ZINI_CACHE_DOUBLE);
+    CHECK(ZINI_GetInt64(section, "count", &number) == ZINI_SUCCESS && number == -5);
+    CHECK(count->cacheType == ZINI_CACHE_INT);
+    bool flag = false;
+    CHECK(ZINI_GetBool(section, "flag", &flag) == ZINI_SUCCESS && flag);
+    CHECK(ZINI_SetValue(section, "flag", "off") == ZINI_SUCCESS);
+    CHECK(ZINI_GetBool(section, "flag", &flag) == ZINI_SUCCESS && !flag);
+
+    // failed conversions cache nothing
+    CHECK(ZINI_GetInt64(section, "word", &number) == ZINI_TYPE_ERROR);
+    CHECK(section->pairs[4].cacheType == ZINI_CACHE_NONE);
+
+    // a removed and re-added key starts without a cache, and pairs moved by a removal keep theirs
+    CHECK(ZINI_GetDouble(section, "ratio", &real) == ZINI_SUCCESS && real == 0.25);
+    CHECK(ZINI_RemovePair(section, "first") == ZINI_SUCCESS);
+    CHECK(ZINI_RemovePair(section, "count") == ZINI_SUCCESS);
+    CHECK(ZINI_AddPair(section, "count", "100") != NULL);
+    CHECK(ZINI_GetInt64(section, "count", &number) == ZINI_SUCCESS && number == 100);
+    Pair* ratio = &section->pairs[0];
+    CHECK(strcmp(ratio->key, "ratio") == 0 && ratio->cacheType == ZINI_CACHE_DOUBLE && ratio->cache.asDouble == 0.25);
+
+    // clones carry the cache, frozen files keep using it but fill no new entries
+    INIFILE copy;
+    CHECK(ZINI_Clone(&iniFile, &copy));
+    CHECK(ZINI_FindSection(&copy, "s")->pairs[0].cacheType == ZINI_CACHE_DOUBLE);
+    CHECK(ZINI_Freeze(&copy));
+    Section* frozen = ZINI_FindSection(&copy, "s");
+    CHECK(ZINI_GetDoubleEx(&copy, "s", "ratio", &real) == ZINI_SUCCESS && real == 0.25);
+    CHECK(ZINI_GetInt64Ex(&copy, "s", "ratio", &number) == ZINI_TYPE_ERROR);
+    CHECK(ZINI_GetBoolEx(&copy, "s", "flag", &flag) == ZINI_SUCCESS && !flag);
+    CHECK(ZINI_GetDoubleEx(&copy, "s", "count", &real) == ZINI_SUCCESS && real == 100.0);
+    CHECK(frozen->pairs[3].cacheType == ZINI_CACHE_INT);
+
+    copy.isModified = false;
+    ZINI_Clean(&copy);
+    iniFile.isModified = false;
+    ZINI_Clean(&iniFile);
+    return check_result("test_cache");
+}
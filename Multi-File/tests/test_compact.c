@@ -0,0 +1,127 @@
+/*
+ * Removals keep the order of what is left, so the indexes have to follow every pair and section that
+ * moves down; ZINI_Compact then rebuilds storage and indexes around the same content.
+ */
+#ifndef _POSIX_C_SOURCE
+    #define _POSIX_C_SOURCE 200809L
+#endif // _POSIX_C_SOURCE
+
+#include "check.h"
+
+#define SECTIONS 12
+#define PAIRS 40
+
+static bool removedPair[SECTIONS][PAIRS];
+static bool removedSection[SECTIONS];
+
+static void fill(INIFILE* iniFile) {
+    char name[16], key[16], value[16];
+    for (int s = 0; s < SECTIONS; s++) {
+        snprintf(name, sizeof(name), "s%d", s);
+        Section* section = ZINI_AddSection(iniFile, name);
+        // every third section stays below ZINI_PAIR_INDEX_THRESHOLD and is searched without an index
+        int pairs = s % 3 == 0 ? 4 : PAIRS;
+        for (int k = 0; k < pairs; k++) {
+            snprintf(key, sizeof(key), "k%d", k);
+            snprintf(value, sizeof(value), "%d.%d", s, k);
+            CHECK(section && ZINI_AddPair(section, key, value) != NULL);
+        }
+    }
+}
+
+// the remaining pairs are in their original order and every lookup path finds exactly them
+static void check_content(INIFILE* iniFile) {
+    char name[16], key[16], value[16];
+    size_t position = 0;
+    for (int s = 0; s < SECTIONS; s++) {
+        snprintf(name, sizeof(name), "s%d", s);
+        Section* section = ZINI_FindSection(iniFile, name);
+        if (removedSection[s]) {
+            CHECK(section == NULL);
+            continue;
+        }
+        CHECK(section == &iniFile->sections[position++]);
+        if (!section) continue;
+
+        int pairs = s % 3 == 0 ? 4 : PAIRS;
+        size_t j = 0;
+        for (int k = 0; k < pairs; k++) {
+            snprintf(key, sizeof(key), "k%d", k);
+            snprintf(value, sizeof(value), "%d.%d", s, k);
+            const char* expected = removedPair[s][k] ? NULL : value;
+            if (expected) CHECK(j < section->pairCount && strcmp(section->pairs[j++].key, key) == 0);
+            CHECK_SAME_VALUE(ZINI_KeyExists(section, key) ? ZINI_GetValue(section, key) : NULL, expected);
+            CHECK_SAME_VALUE(ZINI_Get2(iniFile, name, key), expected);
+        }
+        CHECK(j == section->pairCount);
+    }
+    CHECK(position == iniFile->sectionCount);
+}
+
+static void remove_some(INIFILE* iniFile, int round) {
+    char name[16], key[16];
+    for (int s = 0; s < SECTIONS; s++) {
+        if (removedSection[s]) continue;
+        snprintf(name, sizeof(name), "s%d", s);
+        int pairs = s % 3 == 0 ? 4 : PAIRS;
+        // the first, the last and some in between, so pairs move from everywhere
+        for (int k = 0; k < pairs; k++) {
+            if (removedPair[s][k] || (k + round) % 5 != 0) continue;
+            snprintf(key, sizeof(key), "k%d", k);
+            CHECK(ZINI_RemovePairEx(iniFile, name, key) == ZINI_SUCCESS);
+            removedPair[s][k] = true;
+        }
+    }
+    check_content(iniFile);
+
+    int s = (round * 5 + 1) % SECTIONS;
+    if (!removedSection[s]) {
+        snprintf(name, sizeof(name), "s%d", s);
+        CHECK(ZINI_RemoveSection(iniFile, name) == ZINI_SUCCESS);
+        removedSection[s] = true;
+    }
+}
+
+static void check_compacted(INIFILE* iniFile) {
+    CHECK(ZINI_Compact(iniFile));
+    CHECK(iniFile->mapping == NULL);
+    CHECK(iniFile->sectionCapacity == iniFile->sectionCount);
+    for (size_t i = 0; i < iniFile->sectionCount; i++) CHECK(iniFile->sections[i].pairCapacity == iniFile->sections[i].pairCount);
+    check_content(iniFile);
+}
+
+int main(void) {
+    INIFILE iniFile;
+    ZINI_Init(&iniFile);
+    fill(&iniFile);
+    CHECK(ZINI_Get2(&iniFile, "s1", "k1") != NULL); // builds the path index, so removals must keep it current
+    for (int round = 0; round < 3; round++) {
+        remove_some(&iniFile, round);
+        check_content(&iniFile);
+    }
+    check_compacted(&iniFile);
+
+    // removals and additions after compacting work on the shrunk arrays
+    remove_some(&iniFile, 3);
+    check_content(&iniFile);
+
+    // a mapped file gives up its mapping, values still pointing into it are copied out first
+    char path[] = "/tmp/zini_compact_XXXXXX";
+    CHECK(check_write_file(path, "", 0));
+    CHECK(ZINI_Save(&iniFile, path));
+    INIFILE mapped;
+    CHECK(ZINI_OpenMapped(&mapped, path));
+    CHECK(mapped.mapping != NULL);
+    remove_some(&mapped, 4);
+    check_content(&mapped);
+    check_compacted(&mapped);
+    remove_some(&mapped, 5);
+    check_compacted(&mapped);
+
+    mapped.isModified = false;
+    ZINI_Clean(&mapped);
+    iniFile.isModified = false;
+    ZINI_Clean(&iniFile);
+    unlink(path);
+    return check_result("test_compact");
+}
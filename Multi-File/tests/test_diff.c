@@ -0,0 +1,163 @@
+/*
+ * ZINI_Diff: the records and their order for added, removed and modified sections and keys, and diffs of
+ * random edits that turn the old version into the new one when applied.
+ */
+#ifndef _POSIX_C_SOURCE
+    #define _POSIX_C_SOURCE 200809L
+#endif // _POSIX_C_SOURCE
+
+#include "check.h"
+
+static const char before[] =
+    "[kept]\nsame=1\n"
+    "[changed]\nsame=1\nvalue=old\ngone=x\nemptied=e\n"
+    "[removed]\nr1=1\nr2=2\n";
+
+static const char after[] =
+    "[added]\na1=1\n"
+    "[changed]\nnew=n\nsame=1\nvalue=new\nemptied=\n"
+    "[kept]\nsame=1\n"
+    "[]\n=nameless\n";
+
+// "+", "-" or "~", then section and key, with the quoted old and new value where there is one
+static const char* expected[] = {
+    "+ [added]",
+    "+ [added] a1 -> \"1\"",
+    "~ [changed]",
+    "+ [changed] new -> \"n\"",
+    "~ [changed] value \"old\" -> \"new\"",
+    "~ [changed] emptied \"e\" -> \"\"",
+    "- [changed] gone \"x\"",
+    "+ []",
+    "+ []  -> \"nameless\"",
+    "- [removed]",
+    "- [removed] r1 \"1\"",
+    "- [removed] r2 \"2\"",
+};
+
+static void describe(const ZINI_Change* change, char* out, size_t size) {
+    static const char* marks[] = {"+", "-", "~"};
+    int length = snprintf(out, size, "%s [%s]", marks[change->type], change->section);
+    if (!change->key) return;
+    length += snprintf(out + length, size - (size_t)length, " %s", change->key);
+    if (change->oldValue) length += snprintf(out + length, size - (size_t)length, " \"%s\"", change->oldValue);
+    if (change->newValue) snprintf(out + length, size - (size_t)length, " -> \"%s\"", change->newValue);
+}
+
+static void check_records(void) {
+    INIFILE from, to;
+    CHECK(ZINI_OpenString(&from, before));
+    CHECK(ZINI_OpenString(&to, after));
+
+    ZINI_ChangeSet set;
+    CHECK(ZINI_Diff(&from, &to, &set) == ZINI_SUCCESS);
+    size_t count = sizeof(expected) / sizeof(expected[0]);
+    CHECK(set.count == count);
+    char text[128];
+    for (size_t i = 0; i < set.count && i < count; i++) {
+        describe(&set.changes[i], text, sizeof(text));
+        CHECK_SAME_VALUE(text, expected[i]);
+    }
+    ZINI_FreeChangeSet(&set);
+    CHECK(set.changes == NULL && set.count == 0);
+
+    // a file differs from nothing of itself, and its reverse diff swaps every record
+    CHECK(ZINI_Diff(&to, &to, &set) == ZINI_SUCCESS && set.count == 0);
+    ZINI_FreeChangeSet(&set);
+    CHECK(ZINI_Diff(&to, &from, &set) == ZINI_SUCCESS && set.count == count);
+    size_t added = 0;
+    for (size_t i = 0; i < set.count; i++) added += set.changes[i].type == ZINI_CHANGE_ADDED;
+    CHECK(added == 3 + 1);
+    ZINI_FreeChangeSet(&set);
+    CHECK(ZINI_Diff(NULL, &to, &set) == ZINI_INVALID_INPUT);
+
+    ZINI_Clean(&from);
+    ZINI_Clean(&to);
+}
+
+static uint64_t state = 88172645463325252ULL;
+
+static uint64_t next_random(void) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// applying the pair records of a diff to the old version gives a file with the new version's content
+static void check_apply(size_t rounds) {
+    for (size_t round = 0; round < rounds; round++) {
+        INIFILE from, to;
+        ZINI_Init(&from);
+        char section[16], key[16], value[16];
+        for (int s = 0; s < 6; s++) {
+            snprintf(section, sizeof(section), "s%d", s);
+            Section* owner = ZINI_AddSection(&from, section);
+            for (int k = 0; k < 20; k++) {
+                snprintf(key, sizeof(key), "k%d", k);
+                snprintf(value, sizeof(value), "%d", k);
+                ZINI_AddPair(owner, key, value);
+            }
+        }
+        CHECK(ZINI_Clone(&from, &to));
+        for (int edit = 0; edit < 30; edit++) {
+            uint64_t bits = next_random();
+            snprintf(section, sizeof(section), "s%u", (unsigned)(bits % 8));
+            snprintf(key, sizeof(key), "k%u", (unsigned)((bits >> 8) % 24));
+            snprintf(value, sizeof(value), "v%u", (unsigned)((bits >> 16) % 4));
+            switch ((bits >> 24) % 8) {
+                case 0:
+                    ZINI_RemoveSection(&to, section);
+                    break;
+                case 1:
+                case 2:
+                    ZINI_RemovePairEx(&to, section, key);
+                    break;
+                default: {
+                    Section* owner = ZINI_FindSection(&to, section);
+                    if (!owner) owner = ZINI_AddSection(&to, section);
+                    if (ZINI_SetValue(owner, key, value) != ZINI_SUCCESS) ZINI_AddPair(owner, key, value);
+                    break;
+                }
+            }
+        }
+
+        ZINI_ChangeSet set;
+        CHECK(ZINI_Diff(&from, &to, &set) == ZINI_SUCCESS);
+        for (size_t i = 0; i < set.count; i++) {
+            const ZINI_Change* change = &set.changes[i];
+            if (!change->key) continue;
+            if (change->type == ZINI_CHANGE_REMOVED) {
+                CHECK(ZINI_RemovePairEx(&from, change->section, change->key) == ZINI_SUCCESS);
+                continue;
+            }
+            Section* owner = ZINI_FindSection(&from, change->section);
+            if (!owner) owner = ZINI_AddSection(&from, change->section);
+            if (change->type == ZINI_CHANGE_ADDED) CHECK(ZINI_AddPair(owner, change->key, change->newValue) != NULL);
+            else CHECK(ZINI_SetValue(owner, change->key, change->newValue) == ZINI_SUCCESS);
+        }
+        ZINI_FreeChangeSet(&set);
+
+        // sections left without pairs are the only difference the pair records cannot carry
+        for (size_t i = 0; i < to.sectionCount; i++) {
+            const Section* owner = &to.sections[i];
+            for (size_t j = 0; j < owner->pairCount; j++) {
+                CHECK_SAME_VALUE(ZINI_Get2(&from, owner->section, owner->pairs[j].key), owner->pairs[j].value);
+            }
+        }
+        CHECK(ZINI_Diff(&from, &to, &set) == ZINI_SUCCESS);
+        for (size_t i = 0; i < set.count; i++) CHECK(set.changes[i].key == NULL && set.changes[i].type != ZINI_CHANGE_MODIFIED);
+        ZINI_FreeChangeSet(&set);
+
+        from.isModified = false;
+        to.isModified = false;
+        ZINI_Clean(&from);
+        ZINI_Clean(&to);
+    }
+}
+
+int main(void) {
+    check_records();
+    check_apply(200);
+    return check_result("test_diff");
+}
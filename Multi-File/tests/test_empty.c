@@ -0,0 +1,81 @@
+/*
+ * Empty section names, keys and values are written out like any other, so every way of saving gives a
+ * file that loads back to what was in memory.
+ */
+#ifndef _POSIX_C_SOURCE
+    #define _POSIX_C_SOURCE 200809L
+#endif // _POSIX_C_SOURCE
+
+#include "check.h"
+
+static const char source[] = "[a]\nempty=\n=nokey\nx=1\n[]\ny=2\n";
+
+// what is on disk at path loads back to the same sections and pairs as iniFile
+static void check_reloads(const INIFILE* iniFile, const char* path) {
+    INIFILE reloaded;
+    CHECK(ZINI_Open(&reloaded, path));
+    check_same_contents(iniFile, &reloaded);
+    ZINI_Clean(&reloaded);
+}
+
+static void check_full_saves(const char* path) {
+    INIFILE iniFile;
+    CHECK(ZINI_OpenString(&iniFile, source));
+    CHECK(ZINI_Save(&iniFile, path));
+    check_reloads(&iniFile, path);
+    CHECK(ZINI_SaveAtomic(&iniFile, path));
+    check_reloads(&iniFile, path);
+
+    // what ZINI_Print writes reads back the same as well
+    FILE* stream = tmpfile();
+    CHECK(stream != NULL);
+    if (stream) {
+        ZINI_Print(&iniFile, stream);
+        long length = ftell(stream);
+        char* printed = (char*)calloc(1, (size_t)length + 1);
+        rewind(stream);
+        CHECK(printed && fread(printed, 1, (size_t)length, stream) == (size_t)length);
+        INIFILE parsed;
+        CHECK(printed && ZINI_OpenString(&parsed, printed));
+        if (printed) check_same_contents(&iniFile, &parsed);
+        if (printed) ZINI_Clean(&parsed);
+        free(printed);
+        fclose(stream);
+    }
+    ZINI_Clean(&iniFile);
+}
+
+// in place, behind a resized section and appended, the spliced file still holds every empty name
+static void check_incremental_saves(const char* path) {
+    INIFILE iniFile;
+    CHECK(ZINI_Open(&iniFile, path));
+    CHECK(iniFile.sectionCount == 2);
+
+    CHECK(ZINI_SetValueEx(&iniFile, "a", "x", "2") == ZINI_SUCCESS);
+    CHECK(ZINI_SaveIncremental(&iniFile, path));
+    check_reloads(&iniFile, path);
+
+    CHECK(ZINI_SetValueEx(&iniFile, "", "y", "") == ZINI_SUCCESS);
+    CHECK(ZINI_SetValueEx(&iniFile, "a", "", "longer key-less value") == ZINI_SUCCESS);
+    CHECK(ZINI_SaveIncremental(&iniFile, path));
+    check_reloads(&iniFile, path);
+
+    Section* added = ZINI_AddSection(&iniFile, "added");
+    CHECK(added && ZINI_AddPair(added, "", "") != NULL);
+    CHECK(ZINI_SaveIncremental(&iniFile, path));
+    check_reloads(&iniFile, path);
+
+    CHECK(ZINI_RemoveSection(&iniFile, "a") == ZINI_SUCCESS);
+    CHECK(ZINI_SaveIncremental(&iniFile, path));
+    check_reloads(&iniFile, path);
+    ZINI_Clean(&iniFile);
+}
+
+int main(void) {
+    char path[] = "/tmp/zini_empty_XXXXXX";
+    CHECK(check_write_file(path, "", 0));
+    check_full_saves(path);
+    check_incremental_saves(path);
+    unlink(path);
+    return check_result("test_empty");
+}
@@ -0,0 +1,191 @@
+/*
+ * Values written by ZINI_AddPairVT: integers at the limits of their types, and shortest floating point
+ * text that reads back bit for bit, including subnormals and negative zero.
+ */
+#ifndef _POSIX_C_SOURCE
+    #define _POSIX_C_SOURCE 200809L
+#endif // _POSIX_C_SOURCE
+
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+
+#include "check.h"
+
+typedef struct {
+    double value;
+    const char* text;
+} FormatCase;
+
+static const FormatCase doubleCases[] = {
+    {0.0, "0.0"},
+    {-0.0, "-0.0"},
+    {1.0, "1.0"},
+    {-2.5, "-2.5"},
+    {0.1, "0.1"},
+    {0.3, "0.3"},
+    {100.0, "100.0"},
+    {123456.789, "123456.789"},
+    {1e21, "1e21"},
+    {1e20, "100000000000000000000.0"},
+    {1e-6, "0.000001"},
+    {1e-7, "1e-7"},
+    {5e-324, "5e-324"},
+    {-2.2250738585072014e-308, "-2.2250738585072014e-308"},
+    {DBL_MAX, "1.7976931348623157e308"},
+    {9007199254740993.0, "9007199254740992.0"},
+};
+
+static const FormatCase floatCases[] = {
+    {0.1f, "0.1"},
+    {-0.0f, "-0.0"},
+    {16777216.0f, "16777216.0"},
+    {3.4028235e38f, "3.4028235e38"},
+    {1e-45f, "1e-45"},
+    {1.17549435e-38f, "1.1754944e-38"},
+};
+
+static uint64_t state = 88172645463325252ULL;
+
+static uint64_t next_random(void) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+static const char* write_value(Section* section, void* value, ZINI_DType type) {
+    ZINI_RemovePair(section, "key");
+    Pair* pair = ZINI_AddPairVT(section, "key", value, type);
+    return pair ? pair->value : "";
+}
+
+static void check_integers(Section* section) {
+    int small = INT_MIN;
+    long int wide = LONG_MAX;
+    long long int widest = LLONG_MIN;
+    unsigned int positive = UINT_MAX;
+    char expected[32];
+
+    snprintf(expected, sizeof(expected), "%d", small);
+    CHECK(strcmp(write_value(section, &small, ZINI_INT), expected) == 0);
+    snprintf(expected, sizeof(expected), "%ld", wide);
+    CHECK(strcmp(write_value(section, &wide, ZINI_LINT), expected) == 0);
+    snprintf(expected, sizeof(expected), "%lld", widest);
+    CHECK(strcmp(write_value(section, &widest, ZINI_LLINT), expected) == 0);
+    snprintf(expected, sizeof(expected), "%u", positive);
+    CHECK(strcmp(write_value(section, &positive, ZINI_UINT), expected) == 0);
+    for (int i = 0; i < 10000; i++) {
+        widest = (long long int)next_random() >> (i % 64);
+        snprintf(expected, sizeof(expected), "%lld", widest);
+        CHECK(strcmp(write_value(section, &widest, ZINI_LLINT), expected) == 0);
+    }
+}
+
+// the fewest significant digits %g needs for value to read back unchanged
+static int shortest_digits(double value) {
+    char text[40];
+    for (int precision = 1; precision < 17; precision++) {
+        snprintf(text, sizeof(text), "%.*g", precision, value);
+        if (strtod(text, NULL) == value) return precision;
+    }
+    return 17;
+}
+
+static int significant_digits(const char* text) {
+    int count = 0;
+    int zeros = 0;
+    bool leading = true;
+    for (; *text && *text != 'e'; text++) {
+        if (*text < '0' || *text > '9') continue;
+        if (*text == '0') {
+            if (!leading) zeros++;
+            continue;
+        }
+        count += zeros + 1;
+        zeros = 0;
+        leading = false;
+    }
+    return count ? count : 1;
+}
+
+// random bit patterns, a third of them subnormal, read back exactly; Grisu2 misses the shortest text only
+// when a shorter one lies right at the edge of the rounding interval
+static void check_random_doubles(Section* section, size_t count) {
+    size_t mismatches = 0;
+    size_t longer = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint64_t bits = next_random();
+        if (i % 3 == 0) bits &= 0x800FFFFFFFFFFFFFULL;
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        if (!isfinite(value)) continue;
+
+        const char* text = write_value(section, &value, ZINI_DOUBLE);
+        double back = strtod(text, NULL);
+        if (memcmp(&back, &value, sizeof(value)) != 0) {
+            if (mismatches++ < 5) fprintf(stderr, "%.17g was written as %s\n", value, text);
+            continue;
+        }
+        if (significant_digits(text) > shortest_digits(value)) longer++;
+    }
+    CHECK(mismatches == 0);
+    CHECK(longer < count / 1000);
+}
+
+static void check_random_floats(Section* section, size_t count) {
+    size_t mismatches = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t bits = (uint32_t)next_random();
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        if (!isfinite(value)) continue;
+
+        const char* text = write_value(section, &value, ZINI_FLOAT);
+        float back = strtof(text, NULL);
+        if (memcmp(&back, &value, sizeof(value)) != 0 || significant_digits(text) > 9) {
+            if (mismatches++ < 5) fprintf(stderr, "%.9g was written as %s\n", value, text);
+        }
+    }
+    CHECK(mismatches == 0);
+}
+
+int main(void) {
+    INIFILE iniFile;
+    ZINI_Init(&iniFile);
+    Section* section = ZINI_AddSection(&iniFile, "s");
+    CHECK(section != NULL);
+    if (!section) return check_result("test_format");
+
+    check_integers(section);
+
+    // the default stays fixed precision
+    double half = 0.5;
+    char expected[64];
+    snprintf(expected, sizeof(expected), "%.*f", MAX_DOUBLE_PRECISION, half);
+    CHECK(strcmp(write_value(section, &half, ZINI_DOUBLE), expected) == 0);
+
+    iniFile.floatFormat = ZINI_FORMAT_SHORTEST;
+    for (size_t i = 0; i < sizeof(doubleCases) / sizeof(doubleCases[0]); i++) {
+        double value = doubleCases[i].value;
+        CHECK(strcmp(write_value(section, &value, ZINI_DOUBLE), doubleCases[i].text) == 0);
+    }
+    for (size_t i = 0; i < sizeof(floatCases) / sizeof(floatCases[0]); i++) {
+        float value = (float)floatCases[i].value;
+        CHECK(strcmp(write_value(section, &value, ZINI_FLOAT), floatCases[i].text) == 0);
+    }
+
+    // negative zero survives a read through the typed getter
+    double negativeZero = -0.0;
+    double back = 1;
+    write_value(section, &negativeZero, ZINI_DOUBLE);
+    CHECK(ZINI_GetDouble(section, "key", &back) == ZINI_SUCCESS && back == 0 && signbit(back));
+
+    check_random_doubles(section, 200000);
+    check_random_floats(section, 200000);
+
+    iniFile.isModified = false;
+    ZINI_Clean(&iniFile);
+    return check_result("test_format");
+}
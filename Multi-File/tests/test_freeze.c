@@ -0,0 +1,144 @@
+/*
+ * ZINI_Freeze only changes how lookups are answered, never what they answer: every lookup gives the same
+ * result before and after freezing, empty keys, empty values and empty section names included. Changes
+ * are refused without touching the file, and a clone thaws it.
+ */
+#ifndef _POSIX_C_SOURCE
+    #define _POSIX_C_SOURCE 200809L
+#endif // _POSIX_C_SOURCE
+
+#include "check.h"
+
+#define MAX_QUERIES 1024
+
+typedef struct {
+    char section[32];
+    char key[32];
+    const char* value;     // what ZINI_GetValueEx gave before freezing, NULL for a miss
+    ZINI_Status status;    // what ZINI_GetInt64Ex gave before freezing
+    int64_t number;
+} Query;
+
+static const char source[] =
+    "[plain]\n"
+    "name=zini\n"
+    "count=42\n"
+    "empty=\n"
+    "=no key\n"
+    "[]\n"
+    "nameless=1\n"
+    "[big]\n"
+    "k0=0\nk1=1\nk2=2\nk3=3\nk4=4\nk5=5\nk6=6\nk7=7\nk8=8\nk9=9\nk10=\nk11=-11\n"
+    "[only empty]\n"
+    "a=\n";
+
+static size_t queryCount = 0;
+static Query queries[MAX_QUERIES];
+
+static void add_query(const char* section, const char* key) {
+    if (queryCount == MAX_QUERIES) return;
+    Query* query = &queries[queryCount++];
+    snprintf(query->section, sizeof(query->section), "%s", section);
+    snprintf(query->key, sizeof(query->key), "%s", key);
+}
+
+// every key of every section, asked of every section and of a missing one, plus keys nobody has
+static void build_queries(const INIFILE* iniFile) {
+    static const char* missing[] = {"missing", "NAME", "k12", "nameles"};
+    for (size_t i = 0; i <= iniFile->sectionCount; i++) {
+        const char* section = i < iniFile->sectionCount ? iniFile->sections[i].section : "no such section";
+        for (size_t k = 0; k < iniFile->sectionCount; k++) {
+            const Section* owner = &iniFile->sections[k];
+            for (size_t j = 0; j < owner->pairCount; j++) add_query(section, owner->pairs[j].key);
+        }
+        for (size_t m = 0; m < sizeof(missing) / sizeof(missing[0]); m++) add_query(section, missing[m]);
+    }
+}
+
+static void check_lookups(INIFILE* iniFile) {
+    for (size_t i = 0; i < queryCount; i++) {
+        const Query* query = &queries[i];
+        CHECK_SAME_VALUE(query->value, ZINI_GetValueEx(iniFile, query->section, query->key));
+        CHECK_SAME_VALUE(query->value, ZINI_Get2(iniFile, query->section, query->key));
+        uint64_t hash = ZINI_KeyHash(query->section, query->key);
+        CHECK_SAME_VALUE(query->value, ZINI_GetHashed(iniFile, hash, query->section, query->key));
+
+        int64_t number = 0;
+        ZINI_Status status = ZINI_GetInt64Ex(iniFile, query->section, query->key, &number);
+        CHECK(status == query->status);
+        if (status == ZINI_SUCCESS) CHECK(number == query->number);
+    }
+}
+
+// every mutator fails with nothing moved or changed, so pointers taken before freezing stay valid
+static void check_refuses_changes(INIFILE* iniFile) {
+    Section* plain = ZINI_FindSection(iniFile, "plain");
+    Section* sections = iniFile->sections;
+    Pair* pairs = plain->pairs;
+    size_t sectionCount = iniFile->sectionCount;
+    size_t pairCount = plain->pairCount;
+    const char* name = pairs[0].value;
+    int number = 7;
+
+    CHECK(ZINI_SetValue(plain, "empty", "set") == ZINI_FROZEN_ERROR);
+    CHECK(ZINI_SetValueEx(iniFile, "plain", "name", "set") == ZINI_FROZEN_ERROR);
+    CHECK(ZINI_RemovePair(plain, "count") == ZINI_FROZEN_ERROR);
+    CHECK(ZINI_RemovePairEx(iniFile, "big", "k3") == ZINI_FROZEN_ERROR);
+    CHECK(ZINI_RemoveSection(iniFile, "") == ZINI_FROZEN_ERROR);
+    CHECK(ZINI_AddSection(iniFile, "new") == NULL);
+    CHECK(ZINI_AddPair(plain, "new", "1") == NULL);
+    CHECK(ZINI_AddPairEx(iniFile, "plain", "new", "1") == NULL);
+    CHECK(ZINI_AddPairVT(plain, "new", &number, ZINI_INT) == NULL);
+    CHECK(!ZINI_Reserve(iniFile, 100, 100));
+    CHECK(!ZINI_Compact(iniFile));
+    CHECK(ZINI_Freeze(iniFile));
+
+    CHECK(!iniFile->isModified);
+    CHECK(iniFile->sections == sections && iniFile->sectionCount == sectionCount);
+    CHECK(plain->pairs == pairs && plain->pairCount == pairCount);
+    CHECK(pairs[0].value == name && strcmp(name, "zini") == 0);
+    CHECK(ZINI_GetValueEx(iniFile, "plain", "new") == NULL);
+    CHECK(!ZINI_SectionExists(iniFile, "new"));
+
+    // reads of a frozen file leave the typed value cache as the lookups before freezing filled it
+    Pair* k5 = &ZINI_FindSection(iniFile, "big")->pairs[5];
+    double value = 0;
+    CHECK(k5->cacheType == ZINI_CACHE_INT);
+    CHECK(ZINI_GetDoubleEx(iniFile, "big", "k5", &value) == ZINI_SUCCESS && value == 5.0);
+    CHECK(k5->cacheType == ZINI_CACHE_INT && k5->cache.asInt == 5);
+}
+
+int main(void) {
+    INIFILE iniFile;
+    CHECK(ZINI_OpenString(&iniFile, source));
+    CHECK(ZINI_FindSection(&iniFile, "") != NULL);
+    build_queries(&iniFile);
+
+    size_t found = 0;
+    for (size_t i = 0; i < queryCount; i++) {
+        Query* query = &queries[i];
+        query->value = ZINI_GetValueEx(&iniFile, query->section, query->key);
+        query->status = ZINI_GetInt64Ex(&iniFile, query->section, query->key, &query->number);
+        found += query->value != NULL;
+    }
+    CHECK(found == 18);
+    check_lookups(&iniFile);
+
+    CHECK(ZINI_Freeze(&iniFile));
+    check_lookups(&iniFile);
+    check_refuses_changes(&iniFile);
+    check_lookups(&iniFile);
+
+    // a clone of a frozen file is an ordinary one again
+    INIFILE copy;
+    CHECK(ZINI_Clone(&iniFile, &copy));
+    CHECK(copy.frozen == NULL);
+    CHECK(ZINI_SetValueEx(&copy, "plain", "name", "thawed") == ZINI_SUCCESS);
+    CHECK_SAME_VALUE(ZINI_GetValueEx(&copy, "plain", "name"), "thawed");
+    CHECK_SAME_VALUE(ZINI_GetValueEx(&iniFile, "plain", "name"), "zini");
+    copy.isModified = false;
+    ZINI_Clean(&copy);
+
+    ZINI_Clean(&iniFile);
+    return check_result("test_freeze");
+}
@@ -0,0 +1,69 @@
+/*
+ * ZINI_Handle reads: values changed in place show through the cached pair, and any change that moves
+ * or removes pairs makes the handle resolve again instead of reading freed or shifted memory.
+ */
+#ifndef _POSIX_C_SOURCE
+    #define _POSIX_C_SOURCE 200809L
+#endif // _POSIX_C_SOURCE
+
+#include "check.h"
+
+int main(void) {
+    INIFILE iniFile;
+    CHECK(ZINI_OpenString(&iniFile, "[first]\na=1\n[second]\nx=10\ny=20\nz=30\n"));
+    ZINI_Handle z = ZINI_Resolve(&iniFile, "second", "z");
+    ZINI_Handle missing = ZINI_Resolve(&iniFile, "second", "w");
+    CHECK_SAME_VALUE(ZINI_Read(&z), "30");
+    CHECK(ZINI_Read(&missing) == NULL);
+
+    // an update keeps the pair where it is, the handle reads the new value without resolving
+    Pair* resolved = z.pair;
+    CHECK(ZINI_SetValueEx(&iniFile, "second", "z", "31") == ZINI_SUCCESS);
+    CHECK_SAME_VALUE(ZINI_Read(&z), "31");
+    CHECK(z.pair == resolved);
+
+    // growing the pair array moves every pair of the section
+    Section* second = ZINI_FindSection(&iniFile, "second");
+    char key[16];
+    for (int i = 0; i < 1000; i++) {
+        snprintf(key, sizeof(key), "grow%d", i);
+        CHECK(ZINI_AddPair(second, key, "g") != NULL);
+    }
+    CHECK_SAME_VALUE(ZINI_Read(&z), "31");
+
+    // removing an earlier pair shifts the later ones down
+    CHECK(ZINI_RemovePair(second, "x") == ZINI_SUCCESS);
+    CHECK_SAME_VALUE(ZINI_Read(&z), "31");
+    CHECK(strcmp(z.pair->key, "z") == 0);
+
+    // removing an earlier section shifts the later sections down
+    ZINI_Handle a = ZINI_Resolve(&iniFile, "first", "a");
+    CHECK(ZINI_RemoveSection(&iniFile, "first") == ZINI_SUCCESS);
+    CHECK(ZINI_Read(&a) == NULL);
+    CHECK_SAME_VALUE(ZINI_Read(&z), "31");
+
+    // compaction copies every string
+    CHECK(ZINI_Compact(&iniFile));
+    CHECK_SAME_VALUE(ZINI_Read(&z), "31");
+
+    // a key that is removed reads as missing, and is found again once it comes back
+    CHECK(ZINI_RemovePairEx(&iniFile, "second", "z") == ZINI_SUCCESS);
+    CHECK(ZINI_Read(&z) == NULL);
+    CHECK(ZINI_AddPairEx(&iniFile, "second", "z", "32") != NULL);
+    CHECK_SAME_VALUE(ZINI_Read(&z), "32");
+    CHECK(ZINI_AddPairEx(&iniFile, "second", "w", "new") != NULL);
+    CHECK_SAME_VALUE(ZINI_Read(&missing), "new");
+
+    // a section that comes back after removal is found as well
+    CHECK(ZINI_AddSection(&iniFile, "first") != NULL);
+    CHECK(ZINI_AddPairEx(&iniFile, "first", "a", "2") != NULL);
+    CHECK_SAME_VALUE(ZINI_Read(&a), "2");
+
+    ZINI_Handle none = ZINI_Resolve(NULL, "second", "z");
+    CHECK(ZINI_Read(&none) == NULL);
+    CHECK(ZINI_Read(NULL) == NULL);
+
+    iniFile.isModified = false;
+    ZINI_Clean(&iniFile);
+    return check_result("test_handle");
+}
@@ -0,0 +1,221 @@
+/*
+ * ZINI_SaveIncremental must leave a file that loads back to exactly what was in memory, whichever loader
+ * read it and whether the edits kept section sizes or not, and must leave untouched sections as they were.
+ */
+#ifndef _POSIX_C_SOURCE
+    #define _POSIX_C_SOURCE 200809L
+#endif // _POSIX_C_SOURCE
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "check.h"
+
+#define SECTIONS 30
+#define ROUNDS 40
+
+static unsigned state = 2024;
+
+static size_t random_below(size_t limit) {
+    state = state * 1103515245u + 12345u;
+    return (size_t)(state >> 8) % limit;
+}
+
+static bool open_with(INIFILE* iniFile, const char* path, int loader) {
+    switch (loader) {
+        case 0: return ZINI_Open(iniFile, path);
+        case 1: return ZINI_OpenMapped(iniFile, path);
+        default: return ZINI_OpenParallel(iniFile, path, 4);
+    }
+}
+
+// a few edits of one kind, the same value length keeps the section size so it is overwritten in place
+static void edit(INIFILE* iniFile, size_t round) {
+    char name[64];
+    char key[64];
+    char value[64];
+    size_t edits = 1 + random_below(3);
+    for (size_t e = 0; e < edits && iniFile->sectionCount > 1; e++) {
+        // never the first section, its bytes on disk are checked to stay as they were
+        Section* section = &iniFile->sections[1 + random_below(iniFile->sectionCount - 1)];
+        snprintf(name, sizeof(name), "%s", section->section);
+        switch (random_below(round % 4 == 0 ? 6 : 2)) {
+            case 0:
+            case 1:
+                if (!section->pairCount) break;
+                snprintf(key, sizeof(key), "%s", section->pairs[random_below(section->pairCount)].key);
+                snprintf(value, sizeof(value), round % 2 ? "v%03zu" : "changed in round %zu", round);
+                CHECK(ZINI_SetValue(section, key, value) == ZINI_SUCCESS);
+                break;
+            case 2:
+                snprintf(key, sizeof(key), "added%zu_%zu", round, e);
+                CHECK(ZINI_AddPair(section, key, "new") != NULL);
+                break;
+            case 3:
+                if (!section->pairCount) break;
+                snprintf(key, sizeof(key), "%s", section->pairs[random_below(section->pairCount)].key);
+                CHECK(ZINI_RemovePair(section, key) == ZINI_SUCCESS);
+                break;
+            case 4:
+                CHECK(ZINI_RemoveSection(iniFile, name) == ZINI_SUCCESS);
+                break;
+            default:
+                snprintf(name, sizeof(name), "new%zu_%zu", round, e);
+                section = ZINI_AddSection(iniFile, name);
+                CHECK(section && ZINI_AddPair(section, "fresh", "yes"));
+                break;
+        }
+    }
+}
+
+/*
+ * A file rewritten behind the INIFILE's back keeps its size here, [a] and [b] only trade places, so only
+ * the identity and modification time tell that the recorded offsets no longer fit. A splice with the old
+ * offsets would write [a] over [b] and leave the file with [a] twice.
+ */
+static void check_stale_layout(bool otherFile) {
+    static const char original[] = "[a]\nk=1\n[b]\nx=2\n";
+    static const char swapped[] = "[b]\nx=2\n[a]\nk=1\n";
+
+    char path[] = "/tmp/zini_stale_XXXXXX";
+    char other[] = "/tmp/zini_other_XXXXXX";
+    CHECK(check_write_file(path, original, sizeof(original) - 1));
+    CHECK(check_write_file(other, swapped, sizeof(swapped) - 1));
+
+    INIFILE iniFile;
+    CHECK(ZINI_Open(&iniFile, path));
+    if (!otherFile) {
+        // a same-size rewrite, dated a second later so coarse file system clocks still tell it apart
+        struct stat info;
+        CHECK(stat(path, &info) == 0);
+        FILE* file = fopen(path, "w");
+        CHECK(file && fputs(swapped, file) >= 0);
+        if (file) fclose(file);
+        struct timespec times[2];
+        times[0].tv_sec = info.st_mtime + 1;
+        times[0].tv_nsec = 0;
+        times[1] = times[0];
+        CHECK(utimensat(AT_FDCWD, path, times, 0) == 0);
+    }
+
+    const char* target = otherFile ? other : path;
+    CHECK(ZINI_SetValueEx(&iniFile, "a", "k", "9") == ZINI_SUCCESS);
+    CHECK(ZINI_SaveIncremental(&iniFile, target));
+
+    INIFILE reloaded;
+    CHECK(ZINI_Open(&reloaded, target));
+    if (!check_same_contents(&iniFile, &reloaded)) {
+        fprintf(stderr, "stale layout was spliced into %s\n", otherFile ? "another file" : "a rewritten file");
+        checkFailures++;
+    }
+
+    // once saved, the file is known again and the next save splices
+    CHECK(ZINI_SetValueEx(&iniFile, "b", "x", "3") == ZINI_SUCCESS);
+    CHECK(ZINI_SaveIncremental(&iniFile, target));
+    ZINI_Clean(&reloaded);
+    CHECK(ZINI_Open(&reloaded, target));
+    CHECK(check_same_contents(&iniFile, &reloaded));
+
+    ZINI_Clean(&reloaded);
+    ZINI_Clean(&iniFile);
+    unlink(path);
+    unlink(other);
+}
+
+// saving elsewhere leaves a ZINI_OpenMapped file mapped, saving over the mapped file copies the strings out first
+static void check_mapping_kept(void) {
+    static const char source[] = "[a]\nk=1\nlong=some value\n";
+    char path[] = "/tmp/zini_mapped_XXXXXX";
+    char other[] = "/tmp/zini_unrelated_XXXXXX";
+    CHECK(check_write_file(path, source, sizeof(source) - 1));
+    CHECK(check_write_file(other, "", 0));
+
+    INIFILE iniFile;
+    CHECK(ZINI_OpenMapped(&iniFile, path));
+    CHECK(iniFile.mapping != NULL);
+    CHECK(ZINI_SetValueEx(&iniFile, "a", "k", "2") == ZINI_SUCCESS);
+    CHECK(ZINI_Save(&iniFile, other));
+    CHECK(iniFile.mapping != NULL);
+
+    CHECK(ZINI_SetValueEx(&iniFile, "a", "k", "333") == ZINI_SUCCESS);
+    CHECK(ZINI_Save(&iniFile, path));
+    CHECK(iniFile.mapping == NULL);
+    CHECK_SAME_VALUE(ZINI_GetValueEx(&iniFile, "a", "long"), "some value");
+
+    INIFILE reloaded;
+    CHECK(ZINI_Open(&reloaded, path));
+    CHECK(check_same_contents(&iniFile, &reloaded));
+    ZINI_Clean(&reloaded);
+    ZINI_Clean(&iniFile);
+    unlink(path);
+    unlink(other);
+}
+
+int main(void) {
+    check_stale_layout(false);
+    check_stale_layout(true);
+    check_mapping_kept();
+
+    char source[8192];
+    size_t length = (size_t)snprintf(source, sizeof(source), "; keep me\n[first]\nuntouched=1\n\n");
+    for (size_t i = 0; i < SECTIONS; i++) {
+        length += (size_t)snprintf(source + length, sizeof(source) - length, "[s%zu]\n; section comment\n", i);
+        for (size_t j = 0; j < 4 + i % 12; j++) {
+            length += (size_t)snprintf(source + length, sizeof(source) - length, "k%zu=v%03zu\n", j, i * j);
+        }
+        length += (size_t)snprintf(source + length, sizeof(source) - length, "\n");
+    }
+
+    char path[] = "/tmp/zini_incremental_XXXXXX";
+    CHECK(check_write_file(path, source, length));
+
+    for (size_t round = 0; round < ROUNDS; round++) {
+        INIFILE iniFile;
+        CHECK(open_with(&iniFile, path, (int)(round % 3)));
+
+        // the clone gets the same edits and is what the saved file has to load back as
+        INIFILE edited;
+        CHECK(ZINI_Clone(&iniFile, &edited));
+        unsigned seed = state;
+        edit(&iniFile, round);
+        state = seed;
+        edit(&edited, round);
+        CHECK(check_same_contents(&iniFile, &edited));
+
+        CHECK(ZINI_SaveIncremental(&iniFile, path));
+        CHECK(!iniFile.isModified);
+
+        INIFILE reloaded;
+        CHECK(ZINI_Open(&reloaded, path));
+        if (!check_same_contents(&edited, &reloaded)) {
+            fprintf(stderr, "round %zu: reloaded file differs from the saved one\n", round);
+            checkFailures++;
+        }
+
+        // the untouched first section and the comment in front of it survive every splice
+        char* text = check_read_file(path, NULL);
+        CHECK(text && strncmp(text, "; keep me\n[first]\nuntouched=1\n", 30) == 0);
+        free(text);
+
+        ZINI_Clean(&reloaded);
+        edited.isModified = false;
+        ZINI_Clean(&edited);
+        ZINI_Clean(&iniFile);
+    }
+
+    // saving again without changes leaves every byte where it was
+    size_t beforeLength;
+    char* before = check_read_file(path, &beforeLength);
+    INIFILE iniFile;
+    CHECK(ZINI_Open(&iniFile, path));
+    CHECK(ZINI_SaveIncremental(&iniFile, path));
+    ZINI_Clean(&iniFile);
+    size_t afterLength;
+    char* after = check_read_file(path, &afterLength);
+    CHECK(before && after && beforeLength == afterLength && memcmp(before, after, beforeLength) == 0);
+    free(before);
+    free(after);
+
+    unlink(path);
+    return check_result("test_incremental");
+}
@@ -0,0 +1,123 @@
+/*
+ * ZINI_Overlay and ZINI_Flatten: the topmost layer holding a key wins, and the flattened file keeps the
+ * order of first appearance, owns its strings and starts out unmodified.
+ */
+#ifndef _POSIX_C_SOURCE
+    #define _POSIX_C_SOURCE 200809L
+#endif // _POSIX_C_SOURCE
+
+#include "check.h"
+
+static const char defaults[] =
+    "[server]\nhost=localhost\nport=80\nlog=info\n"
+    "[paths]\nroot=/srv\n"
+    "[unused]\n";
+
+static const char site[] =
+    "[server]\nport=8080\ntimeout=30\n"
+    "[cache]\nsize=64\n";
+
+static const char host[] =
+    "[cache]\nsize=128\n"
+    "[server]\nlog=\nport=9090\n"
+    "[]\n=top\n";
+
+// section, key and value of every pair of the flattened file, in order
+static const char* flatPairs[][3] = {
+    {"server", "host", "localhost"},
+    {"server", "port", "9090"},
+    {"server", "log", ""},
+    {"server", "timeout", "30"},
+    {"paths", "root", "/srv"},
+    {"cache", "size", "128"},
+    {"", "", "top"},
+};
+
+static void check_lookups(const ZINI_OverlayView* view) {
+    CHECK_SAME_VALUE(ZINI_OverlayGet(view, "server", "host"), "localhost");
+    CHECK_SAME_VALUE(ZINI_OverlayGet(view, "server", "port"), "9090");
+    CHECK_SAME_VALUE(ZINI_OverlayGet(view, "server", "timeout"), "30");
+    CHECK_SAME_VALUE(ZINI_OverlayGet(view, "server", "log"), "");
+    CHECK_SAME_VALUE(ZINI_OverlayGet(view, "cache", "size"), "128");
+    CHECK_SAME_VALUE(ZINI_OverlayGet(view, "paths", "root"), "/srv");
+    CHECK_SAME_VALUE(ZINI_OverlayGet(view, "", ""), "top");
+    CHECK(ZINI_OverlayGet(view, "server", "size") == NULL);
+    CHECK(ZINI_OverlayGet(view, "missing", "port") == NULL);
+    CHECK(ZINI_OverlayGet(view, "unused", "") == NULL);
+}
+
+static void check_flat(INIFILE* flat) {
+    static const char* sections[] = {"server", "paths", "unused", "cache", ""};
+    size_t sectionCount = sizeof(sections) / sizeof(sections[0]);
+    CHECK(flat->sectionCount == sectionCount);
+    for (size_t i = 0; i < flat->sectionCount && i < sectionCount; i++) {
+        CHECK_SAME_VALUE(flat->sections[i].section, sections[i]);
+        CHECK(flat->sections[i].pairCapacity == flat->sections[i].pairCount);
+        CHECK(!flat->sections[i].isModified);
+    }
+
+    size_t p = 0;
+    size_t pairCount = sizeof(flatPairs) / sizeof(flatPairs[0]);
+    for (size_t i = 0; i < flat->sectionCount; i++) {
+        const Section* section = &flat->sections[i];
+        for (size_t j = 0; j < section->pairCount; j++, p++) {
+            if (p >= pairCount) continue;
+            CHECK_SAME_VALUE(section->section, flatPairs[p][0]);
+            CHECK_SAME_VALUE(section->pairs[j].key, flatPairs[p][1]);
+            CHECK_SAME_VALUE(section->pairs[j].value, flatPairs[p][2]);
+            CHECK(!section->pairs[j].isModified);
+        }
+    }
+    CHECK(p == pairCount);
+    CHECK(!flat->isModified);
+}
+
+int main(void) {
+    INIFILE layers[3];
+    CHECK(ZINI_OpenString(&layers[0], defaults));
+    CHECK(ZINI_OpenString(&layers[1], site));
+    CHECK(ZINI_OpenString(&layers[2], host));
+    const INIFILE* stack[3] = {&layers[0], &layers[1], &layers[2]};
+
+    ZINI_OverlayView* view = ZINI_Overlay(stack, 3);
+    CHECK(view != NULL);
+    if (!view) return check_result("test_overlay");
+    check_lookups(view);
+
+    // the flattened file stands alone once the layers are gone, and can be cleaned without saving
+    INIFILE flat;
+    CHECK(ZINI_Flatten(view, &flat));
+    ZINI_OverlayFree(view);
+    for (int i = 0; i < 3; i++) ZINI_Clean(&layers[i]);
+    check_flat(&flat);
+    CHECK_SAME_VALUE(ZINI_GetValueEx(&flat, "server", "port"), "9090");
+
+    // a single layer flattens to its own content, and the order of the layers decides the winner
+    const INIFILE* one[1] = {&flat};
+    view = ZINI_Overlay(one, 1);
+    INIFILE again;
+    CHECK(view && ZINI_Flatten(view, &again));
+    check_same_contents(&flat, &again);
+    ZINI_OverlayFree(view);
+
+    CHECK(ZINI_SetValueEx(&again, "server", "port", "1") == ZINI_SUCCESS);
+    const INIFILE* both[2] = {&again, &flat};
+    view = ZINI_Overlay(both, 2);
+    CHECK(view != NULL);
+    if (view) CHECK_SAME_VALUE(ZINI_OverlayGet(view, "server", "port"), "9090");
+    ZINI_OverlayFree(view);
+    both[0] = &flat;
+    both[1] = &again;
+    view = ZINI_Overlay(both, 2);
+    CHECK(view != NULL);
+    if (view) CHECK_SAME_VALUE(ZINI_OverlayGet(view, "server", "port"), "1");
+    ZINI_OverlayFree(view);
+
+    CHECK(ZINI_OverlayGet(NULL, "server", "port") == NULL);
+    CHECK(!ZINI_Flatten(NULL, &again));
+
+    again.isModified = false;
+    ZINI_Clean(&again);
+    ZINI_Clean(&flat);
+    return check_result("test_overlay");
+}
@@ -0,0 +1,100 @@
+/*
+ * ZINI_OpenParallel must give the same INIFILE as ZINI_Open for any thread count. Built with a small
+ * ZINI_MIN_PARSE_CHUNK, so the test files are split into many chunks.
+ */
+#ifndef _POSIX_C_SOURCE
+    #define _POSIX_C_SOURCE 200809L
+#endif // _POSIX_C_SOURCE
+
+#include "check.h"
+
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+} Text;
+
+static void append(Text* text, const char* line) {
+    size_t length = strlen(line);
+    if (text->length + length + 1 > text->capacity) {
+        text->capacity = (text->length + length + 1) * 2;
+        text->data = (char*)realloc(text->data, text->capacity);
+        if (!text->data) abort();
+    }
+    memcpy(text->data + text->length, line, length + 1);
+    text->length += length;
+}
+
+/*
+ * Sections with comments, blank lines and lines that only look like headers, every fifth section name
+ * repeats an earlier one so its pairs are merged. brokenAt puts a "[broken" line without ']' in front
+ * of that section, lines the serial parser skips.
+ */
+static Text build_source(size_t sections, size_t brokenAt) {
+    Text text = {NULL, 0, 0};
+    char line[128];
+    append(&text, "; generated\n");
+    for (size_t i = 0; i < sections; i++) {
+        if (i == brokenAt) append(&text, "[broken\nafter_broken_a=1\nafter_broken_b=2\n");
+        if (i % 7 == 3) append(&text, "[no header either\n");
+        snprintf(line, sizeof(line), "[section%zu]\n", i % 5 == 4 ? i / 2 : i);
+        append(&text, line);
+        for (size_t j = 0; j < 10; j++) {
+            snprintf(line, sizeof(line), "key%zu_%zu=value %zu\n", i, j, i * j);
+            append(&text, line);
+            if (j == 4) append(&text, "; comment\n\n");
+        }
+    }
+    return text;
+}
+
+static void check_threads(const char* path, const INIFILE* serial, int threads) {
+    INIFILE parallel;
+    CHECK(ZINI_OpenParallel(&parallel, path, threads));
+    if (!check_same_contents(serial, &parallel)) {
+        fprintf(stderr, "ZINI_OpenParallel with %d threads differs from ZINI_Open\n", threads);
+        checkFailures++;
+    }
+    ZINI_Clean(&parallel);
+}
+
+static void check_source(Text text) {
+    char path[] = "/tmp/zini_parallel_XXXXXX";
+    CHECK(check_write_file(path, text.data, text.length));
+
+    INIFILE serial;
+    CHECK(ZINI_Open(&serial, path));
+    static const int threads[] = {-1, 0, 1, 2, 3, 8, 64, 1000};
+    for (size_t i = 0; i < sizeof(threads) / sizeof(threads[0]); i++) check_threads(path, &serial, threads[i]);
+
+    ZINI_Clean(&serial);
+    unlink(path);
+    free(text.data);
+}
+
+int main(void) {
+    // "[broken" past the midpoint, where the two thread split looks for its cut
+    Text text = build_source(200, 121);
+    INIFILE serial;
+    CHECK(ZINI_OpenString(&serial, text.data));
+    Section* section = ZINI_FindSection(&serial, "section120");
+    CHECK(section && ZINI_KeyExists(section, "after_broken_a"));
+    ZINI_Clean(&serial);
+    check_source(text);
+
+    // one long section, so "[broken" is the first line starting with '[' after the midpoint
+    Text single = {NULL, 0, 0};
+    char line[64];
+    append(&single, "[single]\n");
+    for (size_t j = 0; j < 1200; j++) {
+        if (j == 600) append(&single, "[broken\n");
+        snprintf(line, sizeof(line), "key%zu=%zu\n", j, j);
+        append(&single, line);
+    }
+    check_source(single);
+
+    // large enough for more chunks than ZINI_OpenParallel has threads
+    check_source(build_source(2000, 1500));
+
+    return check_result("test_parallel");
+}
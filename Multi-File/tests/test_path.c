@@ -0,0 +1,138 @@
+/*
+ * Path lookups through ZINI_Get, ZINI_Get2 and ZINI_GetHashed: dotted names split the way the header
+ * describes, and the pair index stays in step with every change made after it was built.
+ */
+#ifndef _POSIX_C_SOURCE
+    #define _POSIX_C_SOURCE 200809L
+#endif // _POSIX_C_SOURCE
+
+#include "check.h"
+
+static const char source[] =
+    "[a]\nb.c=from a\nkey=a key\n"
+    "[a.b]\nc=from a.b\n"
+    "[a.b.c]\n=empty key\n"
+    "[]\nnameless=1\n"
+    "[trailing.]\n.=dot\n";
+
+// the value a plain walk over the sections and pairs finds, without any index
+static const char* reference_value(const INIFILE* iniFile, const char* section, const char* key) {
+    for (size_t i = 0; i < iniFile->sectionCount; i++) {
+        const Section* owner = &iniFile->sections[i];
+        if (strcmp(owner->section, section) != 0) continue;
+        for (size_t j = 0; j < owner->pairCount; j++) {
+            if (strcmp(owner->pairs[j].key, key) == 0) return owner->pairs[j].value;
+        }
+    }
+    return NULL;
+}
+
+static void check_agrees(INIFILE* iniFile, const char* section, const char* key) {
+    const char* expected = reference_value(iniFile, section, key);
+    char path[64];
+    snprintf(path, sizeof(path), "%s.%s", section, key);
+    CHECK_SAME_VALUE(ZINI_Get2(iniFile, section, key), expected);
+    CHECK_SAME_VALUE(ZINI_GetHashed(iniFile, ZINI_KeyHash(section, key), section, key), expected);
+    if (!strchr(section, '.') && !strchr(key, '.')) CHECK_SAME_VALUE(ZINI_Get(iniFile, path), expected);
+}
+
+static void check_dotted_names(void) {
+    INIFILE iniFile;
+    CHECK(ZINI_OpenString(&iniFile, source));
+
+    // the last dot is tried first, then each earlier one
+    CHECK_SAME_VALUE(ZINI_Get(&iniFile, "a.b.c"), "from a.b");
+    CHECK_SAME_VALUE(ZINI_Get(&iniFile, "a.key"), "a key");
+    CHECK(ZINI_RemovePairEx(&iniFile, "a.b", "c") == ZINI_SUCCESS);
+    CHECK_SAME_VALUE(ZINI_Get(&iniFile, "a.b.c"), "from a");
+    CHECK_SAME_VALUE(ZINI_Get(&iniFile, "a.b.c."), "empty key");
+    CHECK_SAME_VALUE(ZINI_Get(&iniFile, ".nameless"), "1");
+    CHECK_SAME_VALUE(ZINI_Get(&iniFile, "trailing..."), "dot");
+    CHECK(ZINI_Get(&iniFile, "a") == NULL);
+    CHECK(ZINI_Get(&iniFile, "a.b") == NULL);
+    CHECK(ZINI_Get(&iniFile, "") == NULL);
+    CHECK(ZINI_Get(&iniFile, ".") == NULL);
+
+    // the hash has to match the names
+    CHECK_SAME_VALUE(ZINI_GetHashed(&iniFile, ZINI_KeyHash("a", "b.c"), "a", "b.c"), "from a");
+    CHECK(ZINI_GetHashed(&iniFile, ZINI_KeyHash("a", "key"), "a", "b.c") == NULL);
+    CHECK(ZINI_KeyHash("a.b", "c") != ZINI_KeyHash("a", "b.c"));
+
+    iniFile.isModified = false;
+    ZINI_Clean(&iniFile);
+}
+
+static uint64_t state = 88172645463325252ULL;
+
+static uint64_t next_random(void) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// random adds, updates, removals and compactions after the index exists
+static void check_random_changes(size_t rounds) {
+    INIFILE iniFile;
+    ZINI_Init(&iniFile);
+    char section[16], key[16], value[16];
+    CHECK(ZINI_Get(&iniFile, "s0.k0") == NULL);
+
+    for (size_t round = 0; round < rounds; round++) {
+        uint64_t bits = next_random();
+        snprintf(section, sizeof(section), "s%u", (unsigned)(bits % 8));
+        snprintf(key, sizeof(key), "k%u", (unsigned)((bits >> 8) % 64));
+        snprintf(value, sizeof(value), "%zu", round);
+
+        switch ((bits >> 16) % 16) {
+            case 0:
+                ZINI_RemoveSection(&iniFile, section);
+                break;
+            case 1:
+            case 2:
+            case 3:
+            case 4:
+                ZINI_RemovePairEx(&iniFile, section, key);
+                break;
+            case 5:
+            case 6:
+                ZINI_SetValueEx(&iniFile, section, key, value);
+                break;
+            case 7:
+                CHECK(ZINI_Compact(&iniFile));
+                break;
+            default: {
+                Section* owner = ZINI_FindSection(&iniFile, section);
+                if (!owner) owner = ZINI_AddSection(&iniFile, section);
+                if (owner && !reference_value(&iniFile, section, key)) CHECK(ZINI_AddPair(owner, key, value) != NULL);
+                break;
+            }
+        }
+
+        if (round % 64 == 0) {
+            for (unsigned s = 0; s < 8; s++) {
+                for (unsigned k = 0; k < 64; k += 3) {
+                    snprintf(section, sizeof(section), "s%u", s);
+                    snprintf(key, sizeof(key), "k%u", k);
+                    check_agrees(&iniFile, section, key);
+                }
+            }
+        }
+    }
+
+    // a frozen file answers through its own table
+    CHECK(ZINI_Freeze(&iniFile));
+    for (size_t i = 0; i < iniFile.sectionCount; i++) {
+        const Section* owner = &iniFile.sections[i];
+        for (size_t j = 0; j < owner->pairCount; j++) check_agrees(&iniFile, owner->section, owner->pairs[j].key);
+    }
+
+    iniFile.isModified = false;
+    ZINI_Clean(&iniFile);
+}
+
+int main(void) {
+    check_dotted_names();
+    check_random_changes(20000);
+    return check_result("test_path");
+}
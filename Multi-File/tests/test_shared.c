@@ -0,0 +1,151 @@
+/*
+ * ZINI_Shared under load: readers never see a half-applied update or go back to an older version, and
+ * concurrent ZINI_SharedUpdate calls never lose each other's changes.
+ */
+#ifndef _POSIX_C_SOURCE
+    #define _POSIX_C_SOURCE 200809L
+#endif // _POSIX_C_SOURCE
+
+#include <pthread.h>
+
+#include "check.h"
+
+#define READERS 4
+#define WRITERS 2
+#define UPDATES 200
+
+typedef struct {
+    ZINI_Shared* shared;
+    size_t reads;
+    int failures;
+} Reader;
+
+static pthread_mutex_t stopLock = PTHREAD_MUTEX_INITIALIZER;
+static bool stop = false;
+
+static bool stopped(void) {
+    pthread_mutex_lock(&stopLock);
+    bool result = stop;
+    pthread_mutex_unlock(&stopLock);
+    return result;
+}
+
+// a and b are always changed together, so any version with a != b was seen half-built
+static void* read_versions(void* context) {
+    Reader* reader = (Reader*)context;
+    int id = ZINI_SharedRegister(reader->shared);
+    if (id < 0) {
+        reader->failures++;
+        return NULL;
+    }
+
+    int64_t last = 0;
+    bool done = false;
+    while (!done) {
+        done = stopped(); // one more pass after the stop, so the final version is read too
+        INIFILE* version = ZINI_SharedAcquire(reader->shared, id);
+        int64_t a = -1;
+        int64_t b = -2;
+        if (ZINI_GetInt64Ex(version, "counter", "a", &a) != ZINI_SUCCESS ||
+            ZINI_GetInt64Ex(version, "counter", "b", &b) != ZINI_SUCCESS || a != b || a < last) {
+            reader->failures++;
+        }
+        const char* empty = ZINI_GetValueEx(version, "counter", "empty");
+        if (!empty || empty[0] != '\0') reader->failures++;
+        ZINI_SharedRelease(reader->shared, id);
+        last = a;
+        reader->reads++;
+    }
+
+    ZINI_SharedUnregister(reader->shared, id);
+    return NULL;
+}
+
+static bool increment(INIFILE* copy, void* context) {
+    (void)context;
+    int64_t a;
+    if (ZINI_GetInt64Ex(copy, "counter", "a", &a) != ZINI_SUCCESS) return false;
+    char value[32];
+    snprintf(value, sizeof(value), "%lld", (long long)(a + 1));
+    return ZINI_SetValueEx(copy, "counter", "a", value) == ZINI_SUCCESS &&
+           ZINI_SetValueEx(copy, "counter", "b", value) == ZINI_SUCCESS;
+}
+
+typedef struct {
+    int failures;
+    ZINI_Shared* shared;
+} Writer;
+
+static void* write_updates(void* context) {
+    Writer* writer = (Writer*)context;
+    for (int i = 0; i < UPDATES; i++) {
+        if (!ZINI_SharedUpdate(writer->shared, increment, NULL)) writer->failures++;
+    }
+    return NULL;
+}
+
+int main(void) {
+    INIFILE initial;
+    CHECK(ZINI_OpenString(&initial, "[counter]\na=0\nb=0\nempty=\n"));
+    ZINI_Shared* shared = ZINI_SharedCreate(&initial);
+    CHECK(shared != NULL);
+    if (!shared) return check_result("test_shared");
+    CHECK(initial.sectionCount == 0);
+
+    Reader readers[READERS];
+    pthread_t readerThreads[READERS];
+    for (int i = 0; i < READERS; i++) {
+        readers[i].shared = shared;
+        readers[i].reads = 0;
+        readers[i].failures = 0;
+        CHECK(pthread_create(&readerThreads[i], NULL, read_versions, &readers[i]) == 0);
+    }
+
+    Writer writers[WRITERS];
+    pthread_t writerThreads[WRITERS];
+    for (int i = 0; i < WRITERS; i++) {
+        writers[i].failures = 0;
+        writers[i].shared = shared;
+        CHECK(pthread_create(&writerThreads[i], NULL, write_updates, &writers[i]) == 0);
+    }
+    for (int i = 0; i < WRITERS; i++) {
+        pthread_join(writerThreads[i], NULL);
+        CHECK(writers[i].failures == 0);
+    }
+
+    // no update was lost between the two writers
+    int reader = ZINI_SharedRegister(shared);
+    CHECK(reader >= 0);
+    INIFILE* version = ZINI_SharedAcquire(shared, reader);
+    int64_t a = 0;
+    CHECK(ZINI_GetInt64Ex(version, "counter", "a", &a) == ZINI_SUCCESS && a == WRITERS * UPDATES);
+    ZINI_SharedRelease(shared, reader);
+
+    // a version built outside the container replaces the current one as a whole
+    INIFILE next;
+    CHECK(ZINI_OpenString(&next, "[counter]\na=100000\nb=100000\nempty=\n"));
+    CHECK(ZINI_SharedPublish(shared, &next));
+    CHECK(next.sectionCount == 0);
+
+    pthread_mutex_lock(&stopLock);
+    stop = true;
+    pthread_mutex_unlock(&stopLock);
+    for (int i = 0; i < READERS; i++) {
+        pthread_join(readerThreads[i], NULL);
+        CHECK(readers[i].failures == 0);
+        CHECK(readers[i].reads > 0);
+    }
+
+    // updates go on from the published version
+    version = ZINI_SharedAcquire(shared, reader);
+    CHECK(ZINI_GetInt64Ex(version, "counter", "a", &a) == ZINI_SUCCESS && a == 100000);
+    ZINI_SharedRelease(shared, reader);
+    CHECK(ZINI_SharedUpdate(shared, increment, NULL));
+    version = ZINI_SharedAcquire(shared, reader);
+    CHECK(ZINI_GetInt64Ex(version, "counter", "a", &a) == ZINI_SUCCESS && a == 100001);
+    ZINI_SharedRelease(shared, reader);
+    ZINI_SharedUnregister(shared, reader);
+
+    ZINI_SharedDestroy(shared);
+    return check_result("test_shared");
+}
@@ -0,0 +1,130 @@
+/*
+ * Snapshots written by ZINI_Compile: the image holds no pointers, so a copy reads the same wherever it is
+ * mapped, replacing a snapshot leaves open readers alone, and damaged images are refused or answer misses
+ * instead of reading outside the image.
+ */
+#ifndef _POSIX_C_SOURCE
+    #define _POSIX_C_SOURCE 200809L
+#endif // _POSIX_C_SOURCE
+
+#include "check.h"
+
+static const char source[] =
+    "[plain]\n"
+    "name=zini\n"
+    "empty=\n"
+    "=no key\n"
+    "[]\n"
+    "nameless=1\n"
+    "[big]\n"
+    "k0=0\nk1=1\nk2=2\nk3=3\nk4=4\nk5=5\nk6=6\nk7=7\nk8=8\nk9=9\n";
+
+static void check_answers(const ZINI_Snapshot* snapshot) {
+    CHECK_SAME_VALUE(ZINI_SnapshotGetValue(snapshot, "plain", "name"), "zini");
+    CHECK_SAME_VALUE(ZINI_SnapshotGetValue(snapshot, "plain", "empty"), "");
+    CHECK_SAME_VALUE(ZINI_SnapshotGetValue(snapshot, "plain", ""), "no key");
+    CHECK_SAME_VALUE(ZINI_SnapshotGetValue(snapshot, "", "nameless"), "1");
+    CHECK_SAME_VALUE(ZINI_SnapshotGetValue(snapshot, "big", "k7"), "7");
+    CHECK(ZINI_SnapshotGetValue(snapshot, "big", "name") == NULL);
+    CHECK(ZINI_SnapshotGetValue(snapshot, "plain", "k7") == NULL);
+    CHECK(ZINI_SnapshotGetValue(snapshot, "missing", "name") == NULL);
+}
+
+static bool open_image(ZINI_Snapshot* snapshot, const char* image, size_t length) {
+    char path[] = "/tmp/zini_snapshot_XXXXXX";
+    if (!check_write_file(path, image, length)) return false;
+    bool opened = ZINI_OpenSnapshot(snapshot, path);
+    unlink(path);
+    return opened;
+}
+
+// a copy lives at another path and another address, and reads the same as the original next to it
+static void check_copy(const char* image, size_t length) {
+    ZINI_Snapshot first, second;
+    CHECK(open_image(&first, image, length));
+    CHECK(open_image(&second, image, length));
+    CHECK(first.image != second.image);
+    check_answers(&first);
+    check_answers(&second);
+    ZINI_CloseSnapshot(&first);
+    ZINI_CloseSnapshot(&second);
+}
+
+// recompiling replaces the file, a reader of the old version keeps its answers
+static void check_replace(INIFILE* iniFile, const char* path) {
+    ZINI_Snapshot old, current;
+    CHECK(ZINI_OpenSnapshot(&old, path));
+    CHECK(ZINI_SetValueEx(iniFile, "plain", "name", "changed") == ZINI_SUCCESS);
+    CHECK(ZINI_Compile(iniFile, path));
+    CHECK(ZINI_OpenSnapshot(&current, path));
+    check_answers(&old);
+    CHECK_SAME_VALUE(ZINI_SnapshotGetValue(&current, "plain", "name"), "changed");
+    ZINI_CloseSnapshot(&old);
+    ZINI_CloseSnapshot(&current);
+}
+
+// truncations and single damaged bytes anywhere in the image are refused when opening or answered safely
+static void check_damage(const char* image, size_t length) {
+    char* copy = (char*)malloc(length + 1);
+    CHECK(copy != NULL);
+    if (!copy) return;
+
+    ZINI_Snapshot snapshot;
+    CHECK(!open_image(&snapshot, image, 0));
+    CHECK(!open_image(&snapshot, image, 16));
+    CHECK(!open_image(&snapshot, image, length - 1));
+    memcpy(copy, image, length);
+    copy[length] = '\0';
+    CHECK(!open_image(&snapshot, copy, length + 1));
+
+    size_t refused = 0;
+    for (size_t i = 0; i < length; i++) {
+        memcpy(copy, image, length);
+        copy[i] ^= (char)0xA5;
+        if (!open_image(&snapshot, copy, length)) {
+            refused++;
+            continue;
+        }
+        // a damaged record may send a lookup anywhere, the sanitizers catch reads outside the image
+        ZINI_SnapshotGetValue(&snapshot, "plain", "name");
+        ZINI_SnapshotGetValue(&snapshot, "plain", "");
+        ZINI_SnapshotGetValue(&snapshot, "", "nameless");
+        ZINI_SnapshotGetValue(&snapshot, "big", "k9");
+        ZINI_CloseSnapshot(&snapshot);
+    }
+    CHECK(refused > 0);
+    memcpy(copy, "ZINX", 4);
+    CHECK(!open_image(&snapshot, copy, length));
+    free(copy);
+}
+
+int main(void) {
+    INIFILE iniFile;
+    CHECK(ZINI_OpenString(&iniFile, source));
+
+    char path[] = "/tmp/zini_snapshot_XXXXXX";
+    CHECK(check_write_file(path, "", 0));
+    CHECK(ZINI_Compile(&iniFile, path));
+    CHECK(!ZINI_Compile(&iniFile, "/tmp/zini_no_such_directory/snapshot"));
+
+    ZINI_Snapshot snapshot;
+    CHECK(ZINI_OpenSnapshot(&snapshot, path));
+    check_answers(&snapshot);
+    ZINI_CloseSnapshot(&snapshot);
+    CHECK(snapshot.image == NULL);
+
+    size_t length = 0;
+    char* image = check_read_file(path, &length);
+    CHECK(image != NULL);
+    if (image) {
+        check_copy(image, length);
+        check_damage(image, length);
+        free(image);
+    }
+    check_replace(&iniFile, path);
+
+    iniFile.isModified = false;
+    ZINI_Clean(&iniFile);
+    unlink(path);
+    return check_result("test_snapshot");
+}
@@ -0,0 +1,224 @@
+/*
+ * Typed getters: accepted syntax, type and range errors, untouched outputs on failure, and doubles that
+ * match strtod bit for bit.
+ */
+#ifndef _POSIX_C_SOURCE
+    #define _POSIX_C_SOURCE 200809L
+#endif // _POSIX_C_SOURCE
+
+#include <math.h>
+#include <stdint.h>
+
+#include "check.h"
+
+typedef struct {
+    const char* text;
+    ZINI_Status status;
+    int64_t value;
+} IntCase;
+
+typedef struct {
+    const char* text;
+    ZINI_Status status;
+    double value;
+} DoubleCase;
+
+static const IntCase int64Cases[] = {
+    {"0", ZINI_SUCCESS, 0},
+    {"-0", ZINI_SUCCESS, 0},
+    {"+7", ZINI_SUCCESS, 7},
+    {"  42\t", ZINI_SUCCESS, 42},
+    {"0012", ZINI_SUCCESS, 12},
+    {"9223372036854775807", ZINI_SUCCESS, INT64_MAX},
+    {"-9223372036854775808", ZINI_SUCCESS, INT64_MIN},
+    {"9223372036854775808", ZINI_RANGE_ERROR, 0},
+    {"-9223372036854775809", ZINI_RANGE_ERROR, 0},
+    {"99999999999999999999999", ZINI_RANGE_ERROR, 0},
+    {"0x10", ZINI_TYPE_ERROR, 0},
+    {"12a", ZINI_TYPE_ERROR, 0},
+    {"1e3", ZINI_TYPE_ERROR, 0},
+    {"1.0", ZINI_TYPE_ERROR, 0},
+    {"-", ZINI_TYPE_ERROR, 0},
+    {"+-1", ZINI_TYPE_ERROR, 0},
+    {"1 2", ZINI_TYPE_ERROR, 0},
+    {"", ZINI_TYPE_ERROR, 0},
+};
+
+static const IntCase intCases[] = {
+    {"2147483647", ZINI_SUCCESS, INT32_MAX},
+    {"-2147483648", ZINI_SUCCESS, INT32_MIN},
+    {"2147483648", ZINI_RANGE_ERROR, 0},
+    {"-2147483649", ZINI_RANGE_ERROR, 0},
+};
+
+static const IntCase uintCases[] = {
+    {"4294967295", ZINI_SUCCESS, UINT32_MAX},
+    {"0", ZINI_SUCCESS, 0},
+    {"4294967296", ZINI_RANGE_ERROR, 0},
+    {"-1", ZINI_RANGE_ERROR, 0},
+};
+
+static const DoubleCase doubleCases[] = {
+    {"0.5", ZINI_SUCCESS, 0.5},
+    {".5", ZINI_SUCCESS, 0.5},
+    {"5.", ZINI_SUCCESS, 5.0},
+    {"-2.5e-3", ZINI_SUCCESS, -2.5e-3},
+    {"1E2", ZINI_SUCCESS, 100.0},
+    {" 3 ", ZINI_SUCCESS, 3.0},
+    {"1.7976931348623157e308", ZINI_SUCCESS, 1.7976931348623157e308},
+    {"4.9e-324", ZINI_SUCCESS, 4.9e-324},
+    {"1e-400", ZINI_SUCCESS, 0.0},
+    {"1e400", ZINI_RANGE_ERROR, 0},
+    {"-1e400", ZINI_RANGE_ERROR, 0},
+    {"0x10", ZINI_TYPE_ERROR, 0},
+    {"1e", ZINI_TYPE_ERROR, 0},
+    {"inf", ZINI_TYPE_ERROR, 0},
+    {"nan", ZINI_TYPE_ERROR, 0},
+    {"1.2.3", ZINI_TYPE_ERROR, 0},
+    {"", ZINI_TYPE_ERROR, 0},
+};
+
+static Section* single_value(INIFILE* iniFile, const char* text) {
+    ZINI_Init(iniFile);
+    Section* section = ZINI_AddSection(iniFile, "typed");
+    ZINI_AddPair(section, "key", text);
+    iniFile->isModified = false;
+    return section;
+}
+
+static void check_int64(const IntCase* test) {
+    INIFILE iniFile;
+    Section* section = single_value(&iniFile, test->text);
+    int64_t value = 12345;
+    ZINI_Status status = ZINI_GetInt64(section, "key", &value);
+    if (status != test->status || value != (status == ZINI_SUCCESS ? test->value : 12345)) {
+        fprintf(stderr, "GetInt64(\"%s\") gave status %d value %lld\n", test->text, status, (long long)value);
+        checkFailures++;
+    }
+    ZINI_Clean(&iniFile);
+}
+
+static void check_int(const IntCase* test) {
+    INIFILE iniFile;
+    Section* section = single_value(&iniFile, test->text);
+    int value = 12345;
+    ZINI_Status status = ZINI_GetInt(section, "key", &value);
+    if (status != test->status || value != (status == ZINI_SUCCESS ? (int)test->value : 12345)) {
+        fprintf(stderr, "GetInt(\"%s\") gave status %d value %d\n", test->text, status, value);
+        checkFailures++;
+    }
+    ZINI_Clean(&iniFile);
+}
+
+static void check_uint(const IntCase* test) {
+    INIFILE iniFile;
+    Section* section = single_value(&iniFile, test->text);
+    unsigned int value = 12345;
+    ZINI_Status status = ZINI_GetUInt(section, "key", &value);
+    if (status != test->status || value != (status == ZINI_SUCCESS ? (unsigned int)test->value : 12345u)) {
+        fprintf(stderr, "GetUInt(\"%s\") gave status %d value %u\n", test->text, status, value);
+        checkFailures++;
+    }
+    ZINI_Clean(&iniFile);
+}
+
+static void check_double(const DoubleCase* test) {
+    INIFILE iniFile;
+    Section* section = single_value(&iniFile, test->text);
+    double value = 12345.0;
+    ZINI_Status status = ZINI_GetDouble(section, "key", &value);
+    if (status != test->status || value != (status == ZINI_SUCCESS ? test->value : 12345.0)) {
+        fprintf(stderr, "GetDouble(\"%s\") gave status %d value %.17g\n", test->text, status, value);
+        checkFailures++;
+    }
+    ZINI_Clean(&iniFile);
+}
+
+static void check_bools(void) {
+    static const char* trues[] = {"true", "TRUE", "Yes", "on", "1"};
+    static const char* falses[] = {"false", "False", "NO", "off", "0"};
+    static const char* invalid[] = {"2", "truex", "y", "", "-1"};
+    for (size_t i = 0; i < 5; i++) {
+        INIFILE iniFile;
+        bool value = false;
+        CHECK(ZINI_GetBool(single_value(&iniFile, trues[i]), "key", &value) == ZINI_SUCCESS && value);
+        ZINI_Clean(&iniFile);
+        value = true;
+        CHECK(ZINI_GetBool(single_value(&iniFile, falses[i]), "key", &value) == ZINI_SUCCESS && !value);
+        ZINI_Clean(&iniFile);
+        value = true;
+        CHECK(ZINI_GetBool(single_value(&iniFile, invalid[i]), "key", &value) == ZINI_TYPE_ERROR && value);
+        ZINI_Clean(&iniFile);
+    }
+}
+
+static uint64_t state = 88172645463325252ULL;
+
+static uint64_t next_random(void) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// shortest forms, full precision forms and short decimals with wide exponents all round like strtod
+static void check_against_strtod(size_t count) {
+    INIFILE iniFile;
+    Section* section = single_value(&iniFile, "0");
+    char text[64];
+    size_t mismatches = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint64_t bits = next_random();
+        double source;
+        memcpy(&source, &bits, sizeof(source));
+        switch (i % 3) {
+            case 0:
+                if (!isfinite(source)) continue;
+                snprintf(text, sizeof(text), "%.17g", source);
+                break;
+            case 1:
+                if (!isfinite(source)) continue;
+                snprintf(text, sizeof(text), "%.*g", (int)(bits % 17) + 1, source);
+                break;
+            default:
+                snprintf(text, sizeof(text), "%llu.%llue%d", (unsigned long long)(bits % 100000),
+                         (unsigned long long)(bits >> 40) % 1000, (int)((bits >> 20) % 700) - 350);
+                break;
+        }
+
+        double expected = strtod(text, NULL);
+        double value = 0;
+        CHECK(ZINI_SetValue(section, "key", text) == ZINI_SUCCESS);
+        ZINI_Status status = ZINI_GetDouble(section, "key", &value);
+        if (isinf(expected)) {
+            if (status != ZINI_RANGE_ERROR) mismatches++;
+        }
+        else if (status != ZINI_SUCCESS || memcmp(&value, &expected, sizeof(value)) != 0) {
+            if (mismatches++ < 5) fprintf(stderr, "GetDouble(\"%s\") gave %.17g, strtod %.17g\n", text, value, expected);
+        }
+    }
+    CHECK(mismatches == 0);
+    iniFile.isModified = false;
+    ZINI_Clean(&iniFile);
+}
+
+int main(void) {
+    for (size_t i = 0; i < sizeof(int64Cases) / sizeof(int64Cases[0]); i++) check_int64(&int64Cases[i]);
+    for (size_t i = 0; i < sizeof(intCases) / sizeof(intCases[0]); i++) check_int(&intCases[i]);
+    for (size_t i = 0; i < sizeof(uintCases) / sizeof(uintCases[0]); i++) check_uint(&uintCases[i]);
+    for (size_t i = 0; i < sizeof(doubleCases) / sizeof(doubleCases[0]); i++) check_double(&doubleCases[i]);
+    check_bools();
+    check_against_strtod(100000);
+
+    // misses are reported through the status, section misses only by the Ex variants
+    INIFILE iniFile;
+    Section* section = single_value(&iniFile, "1");
+    int64_t value = 5;
+    CHECK(ZINI_GetInt64(section, "missing", &value) == ZINI_KEY_NOT_FOUND && value == 5);
+    CHECK(ZINI_GetInt64Ex(&iniFile, "missing", "key", &value) == ZINI_SECTION_NOT_FOUND && value == 5);
+    CHECK(ZINI_GetInt64(section, NULL, &value) == ZINI_INVALID_INPUT);
+    CHECK(ZINI_GetInt64(section, "key", NULL) == ZINI_INVALID_INPUT);
+    ZINI_Clean(&iniFile);
+
+    return check_result("test_typed");
+}
@@ -0,0 +1,120 @@
+/*
+ * ZINI_Watch: replacing the watched file publishes the new version and reports exactly the changed
+ * pairs, while a file that is gone by the time it is read leaves the current version in place.
+ */
+#ifndef _POSIX_C_SOURCE
+    #define _POSIX_C_SOURCE 200809L
+#endif // _POSIX_C_SOURCE
+
+#include <pthread.h>
+#include <time.h>
+
+#include "check.h"
+
+typedef struct {
+    pthread_mutex_t lock;
+    int calls;
+    size_t count;
+    char records[8][64];    // "type section key old new" per change, the strings die with the callback
+} Seen;
+
+static void record_changes(ZINI_Shared* shared, const ZINI_Change* changes, size_t count, void* context) {
+    (void)shared;
+    Seen* seen = (Seen*)context;
+    pthread_mutex_lock(&seen->lock);
+    seen->calls++;
+    seen->count = count;
+    for (size_t i = 0; i < count && i < 8; i++) {
+        snprintf(seen->records[i], sizeof(seen->records[i]), "%d %s %s %s %s", (int)changes[i].type,
+                 changes[i].section, changes[i].key ? changes[i].key : "-",
+                 changes[i].oldValue ? changes[i].oldValue : "-", changes[i].newValue ? changes[i].newValue : "-");
+    }
+    pthread_mutex_unlock(&seen->lock);
+}
+
+static int calls_of(Seen* seen) {
+    pthread_mutex_lock(&seen->lock);
+    int calls = seen->calls;
+    pthread_mutex_unlock(&seen->lock);
+    return calls;
+}
+
+static bool wait_for_call(Seen* seen, int calls) {
+    struct timespec pause = {0, 5000000};
+    for (int i = 0; i < 1000; i++) {
+        if (calls_of(seen) >= calls) return true;
+        nanosleep(&pause, NULL);
+    }
+    return false;
+}
+
+static bool has_record(Seen* seen, const char* record) {
+    for (size_t i = 0; i < seen->count && i < 8; i++) {
+        if (strcmp(seen->records[i], record) == 0) return true;
+    }
+    return false;
+}
+
+static bool replace_file(const char* path, const char* directory, const char* data) {
+    char temp[64];
+    snprintf(temp, sizeof(temp), "%s/next_XXXXXX", directory);
+    return check_write_file(temp, data, strlen(data)) && rename(temp, path) == 0;
+}
+
+int main(void) {
+    char directory[] = "/tmp/zini_watch_XXXXXX";
+    CHECK(mkdtemp(directory) != NULL);
+    char path[64];
+    snprintf(path, sizeof(path), "%s/config.ini", directory);
+    CHECK(replace_file(path, directory, "[s]\na=1\nb=2\n"));
+
+    INIFILE initial;
+    CHECK(ZINI_Open(&initial, path));
+    ZINI_Shared* shared = ZINI_SharedCreate(&initial);
+    int reader = ZINI_SharedRegister(shared);
+    Seen seen = {PTHREAD_MUTEX_INITIALIZER, 0, 0, {{0}}};
+    ZINI_Watcher* watcher = ZINI_Watch(shared, path, record_changes, &seen);
+    CHECK(shared && reader >= 0 && watcher);
+    if (!shared || reader < 0 || !watcher) return check_result("test_watch");
+
+    // a replaced file is published with its changes
+    CHECK(replace_file(path, directory, "[s]\na=1\nb=3\nc=4\n"));
+    CHECK(wait_for_call(&seen, 1));
+    pthread_mutex_lock(&seen.lock);
+    CHECK(has_record(&seen, "2 s b 2 3"));
+    CHECK(has_record(&seen, "0 s c - 4"));
+    CHECK(!has_record(&seen, "2 s a 1 1"));
+    pthread_mutex_unlock(&seen.lock);
+    INIFILE* version = ZINI_SharedAcquire(shared, reader);
+    CHECK_SAME_VALUE(ZINI_GetValueEx(version, "s", "c"), "4");
+    ZINI_SharedRelease(shared, reader);
+
+    // files removed right after being written are read as missing, never published as empty
+    for (int i = 0; i < 20; i++) {
+        CHECK(replace_file(path, directory, "[s]\na=1\nb=3\nc=4\n"));
+        unlink(path);
+    }
+    struct timespec pause = {0, 200000000};
+    nanosleep(&pause, NULL);
+    CHECK(replace_file(path, directory, "[s]\na=5\nb=3\nc=4\n"));
+    CHECK(wait_for_call(&seen, 2));
+    pthread_mutex_lock(&seen.lock);
+    CHECK(seen.calls == 2);
+    CHECK(seen.count >= 1 && has_record(&seen, "2 s a 1 5"));
+    CHECK(!has_record(&seen, "0 s b - 3"));
+    pthread_mutex_unlock(&seen.lock);
+
+    // a file that is gone for good leaves the last version
+    unlink(path);
+    nanosleep(&pause, NULL);
+    version = ZINI_SharedAcquire(shared, reader);
+    CHECK_SAME_VALUE(ZINI_GetValueEx(version, "s", "a"), "5");
+    ZINI_SharedRelease(shared, reader);
+
+    ZINI_Unwatch(watcher);
+    CHECK(calls_of(&seen) == 2);
+    ZINI_SharedUnregister(shared, reader);
+    ZINI_SharedDestroy(shared);
+    rmdir(directory);
+    return check_result("test_watch");
+}
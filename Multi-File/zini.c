@@ -1,366 +1,4270 @@
+#ifndef _POSIX_C_SOURCE
+    #define _POSIX_C_SOURCE 200809L
+#endif // _POSIX_C_SOURCE
+
 #include <string.h>
 #include <errno.h>
+#include <float.h>
+#include <limits.h>
 #include <stdlib.h>
 
 #include "zini.h"
 
-void ZINI_Init(INIFILE *iniFile) {
-    if (!iniFile) return;
-    iniFile->sections = NULL;
-    iniFile->sectionCount = 0;
-    iniFile->isModified = false;
+#if defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+    #define ZINI_HAVE_SSE2 1
+    #include <emmintrin.h>
+#else
+    #define ZINI_HAVE_SSE2 0
+#endif
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    #define ZINI_LITTLE_ENDIAN 1
+#elif defined(_WIN32)
+    #define ZINI_LITTLE_ENDIAN 1
+#else
+    #define ZINI_LITTLE_ENDIAN 0
+#endif
+
+// the fast double path needs arithmetic done in plain double precision, x87 rounds twice
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+    #define ZINI_EXACT_DOUBLE 1
+#else
+    #define ZINI_EXACT_DOUBLE 0
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+    #define ZINI_HAVE_MMAP
+    #define ZINI_HAVE_PTHREADS
+    #include <pthread.h>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#if defined(__linux__)
+    #define ZINI_HAVE_INOTIFY
+    #include <poll.h>
+    #include <sys/inotify.h>
+#endif
+
+// ZINI_Shared needs atomic loads, stores and exchanges, without compiler support it is only safe on one thread
+#if defined(__GNUC__) || defined(__clang__)
+    #define ZINI_ATOMIC_LOAD(ptr) __atomic_load_n((ptr), __ATOMIC_SEQ_CST)
+    #define ZINI_ATOMIC_STORE(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_SEQ_CST)
+    #define ZINI_ATOMIC_EXCHANGE(ptr, value) __atomic_exchange_n((ptr), (value), __ATOMIC_SEQ_CST)
+    #define ZINI_ATOMIC_INCREMENT(ptr) __atomic_add_fetch((ptr), 1, __ATOMIC_SEQ_CST)
+    #define ZINI_ATOMIC_CLAIM(ptr) (__atomic_exchange_n((ptr), 1, __ATOMIC_SEQ_CST) == 0)
+#else
+    #define ZINI_ATOMIC_LOAD(ptr) (*(ptr))
+    #define ZINI_ATOMIC_STORE(ptr, value) (*(ptr) = (value))
+    #define ZINI_ATOMIC_EXCHANGE(ptr, value) zini_exchange_pointer((void**)(ptr), (value))
+    #define ZINI_ATOMIC_INCREMENT(ptr) (++*(ptr))
+    #define ZINI_ATOMIC_CLAIM(ptr) (*(ptr) ? 0 : (*(ptr) = 1))
+
+static void* zini_exchange_pointer(void** ptr, void* value) {
+    void* old = *ptr;
+    *ptr = value;
+    return old;
 }
+#endif
 
-bool ZINI_Open(INIFILE* iniFile, const char* filename) {
-    if (!iniFile || !filename) {
-        fprintf(stderr, "INI file or file name is NULL!\n");
+#define ZINI_INDEX_MIN_CAPACITY 16
+#define ZINI_ARRAY_MIN_CAPACITY 8
+#define ZINI_MAX_PARSE_THREADS 64
+
+// below this many bytes per thread a parallel parse costs more than it saves
+#ifndef ZINI_MIN_PARSE_CHUNK
+    #define ZINI_MIN_PARSE_CHUNK (1024 * 1024)
+#endif // ZINI_MIN_PARSE_CHUNK
+
+// scratch space for ZINI_AddPairVT, numbers in shortest form need at most 32 bytes
+#define ZINI_FORMAT_BUFFER (MAX_VALUE_LENGTH > 32 ? MAX_VALUE_LENGTH : 32)
+
+#ifndef ZINI_ARENA_BLOCK_SIZE
+    #define ZINI_ARENA_BLOCK_SIZE (64 * 1024)
+#endif // ZINI_ARENA_BLOCK_SIZE
+
+struct INIArenaBlock {
+    struct INIArenaBlock* next;
+    size_t used;
+    size_t capacity;
+    char data[];
+};
+
+// FNV-1a, good enough spread for section and key names
+static uint64_t zini_hash_continue(uint64_t hash, const char* str, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)str[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static uint64_t zini_hash(const char* str, size_t length) {
+    return zini_hash_continue(14695981039346656037ULL, str, length);
+}
+
+// hash of a (section, key) pair: the section's hash continued over a NUL separator and the key
+static uint64_t zini_pair_hash(uint64_t sectionHash, const char* key, size_t length) {
+    return zini_hash_continue(sectionHash * 1099511628211ULL, key, length);
+}
+
+// blocks are never moved, so strings handed out stay valid until ZINI_Clean
+static char* zini_arena_alloc(INIFILE* iniFile, size_t size) {
+    ZINI_ArenaBlock* head = iniFile->arena;
+    if (head && head->capacity - head->used >= size) {
+        char* ptr = head->data + head->used;
+        head->used += size;
+        return ptr;
+    }
+
+    // oversized strings get a block of their own behind the head, so the head keeps its free space
+    bool dedicated = size > ZINI_ARENA_BLOCK_SIZE / 4;
+    size_t capacity = dedicated ? size : ZINI_ARENA_BLOCK_SIZE;
+    ZINI_ArenaBlock* block = (ZINI_ArenaBlock*)malloc(sizeof(ZINI_ArenaBlock) + capacity);
+    if (!block) {
+        perror("Failed to allocate memory for strings");
+        return NULL;
+    }
+
+    block->used = size;
+    block->capacity = capacity;
+    if (dedicated && head) {
+        block->next = head->next;
+        head->next = block;
+    }
+    else {
+        block->next = head;
+        iniFile->arena = block;
+    }
+    return block->data;
+}
+
+static const char* zini_arena_strndup(INIFILE* iniFile, const char* str, size_t length) {
+    char* copy = zini_arena_alloc(iniFile, length + 1);
+    if (!copy) return NULL;
+    memcpy(copy, str, length);
+    copy[length] = '\0';
+    return copy;
+}
+
+static void zini_arena_free(INIFILE* iniFile) {
+    ZINI_ArenaBlock* block = iniFile->arena;
+    while (block) {
+        ZINI_ArenaBlock* next = block->next;
+        free(block);
+        block = next;
+    }
+    iniFile->arena = NULL;
+}
+
+static void zini_index_free(ZINI_Index* index) {
+    free(index->slots);
+    index->slots = NULL;
+    index->capacity = 0;
+    index->count = 0;
+}
+
+static bool zini_index_resize(ZINI_Index* index, size_t capacity) {
+    ZINI_IndexSlot* slots = (ZINI_IndexSlot*)calloc(capacity, sizeof(ZINI_IndexSlot));
+    if (!slots) {
+        perror("Failed to allocate memory for index");
         return false;
     }
 
-    ZINI_Init(iniFile);
+    size_t mask = capacity - 1;
+    for (size_t i = 0; i < index->capacity; i++) {
+        if (!index->slots[i].position) continue;
+        size_t j = index->slots[i].hash & mask;
+        while (slots[j].position) j = (j + 1) & mask;
+        slots[j] = index->slots[i];
+    }
 
-    FILE *file = fopen(filename, "r");
-    if (!file) {
-        if (errno == ENOENT) return true;
-        perror("Error opening INI file");
+    free(index->slots);
+    index->slots = slots;
+    index->capacity = capacity;
+    return true;
+}
+
+static bool zini_index_reserve(ZINI_Index* index, size_t count) {
+    size_t capacity = index->capacity ? index->capacity : ZINI_INDEX_MIN_CAPACITY;
+    while (count * 2 > capacity) capacity *= 2;
+    if (capacity == index->capacity) return true;
+    return zini_index_resize(index, capacity);
+}
+
+// keeps the load factor at or below 1/2 so probe chains stay short
+static bool zini_index_insert(ZINI_Index* index, uint64_t hash, size_t position) {
+    if ((index->count + 1) * 2 > index->capacity) {
+        size_t capacity = index->capacity ? index->capacity * 2 : ZINI_INDEX_MIN_CAPACITY;
+        if (!zini_index_resize(index, capacity)) return false;
+    }
+
+    size_t mask = index->capacity - 1;
+    size_t i = hash & mask;
+    while (index->slots[i].position) i = (i + 1) & mask;
+    index->slots[i].hash = hash;
+    index->slots[i].position = position + 1;
+    index->count++;
+    return true;
+}
+
+// backward-shift deletion, so no tombstones are left behind in the probe chains
+static void zini_index_remove(ZINI_Index* index, uint64_t hash, size_t position) {
+    if (!index->capacity) return;
+
+    size_t mask = index->capacity - 1;
+    size_t i = hash & mask;
+    while (index->slots[i].position != position + 1) {
+        if (!index->slots[i].position) return;
+        i = (i + 1) & mask;
+    }
+
+    for (size_t j = (i + 1) & mask; index->slots[j].position; j = (j + 1) & mask) {
+        size_t home = index->slots[j].hash & mask;
+        bool reachable = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+        if (!reachable) {
+            index->slots[i] = index->slots[j];
+            i = j;
+        }
+    }
+
+    index->slots[i].position = 0;
+    index->count--;
+}
+
+// re-points the entry of a moved element, the hash and so the probe chain stay the same
+static void zini_index_move(ZINI_Index* index, uint64_t hash, size_t from, size_t to) {
+    if (!index->capacity) return;
+
+    size_t mask = index->capacity - 1;
+    for (size_t i = hash & mask; index->slots[i].position; i = (i + 1) & mask) {
+        if (index->slots[i].position == from + 1) {
+            index->slots[i].position = to + 1;
+            return;
+        }
+    }
+}
+
+// shrinks the slot table to the smallest capacity insertions would have left it at
+static void zini_index_fit(ZINI_Index* index) {
+    if (!index->capacity) return;
+
+    size_t capacity = ZINI_INDEX_MIN_CAPACITY;
+    while (index->count * 2 > capacity) capacity *= 2;
+    if (capacity < index->capacity) zini_index_resize(index, capacity);
+}
+
+/*
+ * Perfect hash in the hash-and-displace style of CHD and PTHash. Entries are spread over buckets of
+ * about ZINI_PHF_BUCKET_SIZE, and each bucket gets a pilot, found at build time, that moves all its
+ * entries into free slots. A lookup is then one bucket read and one slot read, with no probing.
+ * Slots map to entry indices, so the table need not be minimal: keeping one slot in ZINI_PHF_SPARE_SLOTS
+ * empty spares the last buckets from hunting for the very last free slots, which otherwise costs more
+ * than placing all the others.
+ */
+#define ZINI_PHF_BUCKET_SIZE 2
+#define ZINI_PHF_SPARE_SLOTS 64
+#define ZINI_PHF_ATTEMPTS 16
+
+typedef struct {
+    uint64_t seed;
+    uint32_t bucketCount;
+    uint32_t slotCount;
+    uint32_t* pilots;   // one per bucket
+    uint32_t* slots;    // entry index for every slot, UINT32_MAX for an empty one
+} ZINI_PerfectHash;
+
+// splitmix64 finalizer, turns the weak low bits of FNV into well spread ones
+static uint64_t zini_mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// maps the upper half of x onto [0, n) with a multiply instead of a division
+static uint32_t zini_reduce(uint64_t x, uint32_t n) {
+    return (uint32_t)(((x >> 32) * n) >> 32);
+}
+
+static uint32_t zini_phf_bucket(uint64_t mixed, uint32_t bucketCount) {
+    return zini_reduce(mixed, bucketCount);
+}
+
+// the pilot is mixed in before the final mix, XOR after it would shift all entries of a bucket alike
+static uint32_t zini_phf_position(uint64_t mixed, uint32_t pilot, uint32_t slotCount) {
+    return zini_reduce(zini_mix(mixed + pilot * 0x9E3779B97F4A7C15ULL), slotCount);
+}
+
+// slot of an entry with the given hash, only meaningful for hashes the table was built from
+static uint32_t zini_phf_slot(uint64_t seed, const uint32_t* pilots, uint32_t bucketCount, uint32_t slotCount, uint64_t hash) {
+    uint64_t mixed = zini_mix(hash ^ seed);
+    return zini_phf_position(mixed, pilots[zini_phf_bucket(mixed, bucketCount)], slotCount);
+}
+
+static void zini_phf_free(ZINI_PerfectHash* phf) {
+    free(phf->pilots);
+    free(phf->slots);
+    phf->pilots = NULL;
+    phf->slots = NULL;
+    phf->bucketCount = 0;
+    phf->slotCount = 0;
+}
+
+// tries to place every bucket with one seed, largest buckets first while most slots are still free
+static bool zini_phf_place(ZINI_PerfectHash* phf, const uint64_t* hashes, uint32_t count, uint64_t* mixed,
+                           uint32_t* bucketStart, uint32_t* members, uint32_t* order) {
+    uint32_t bucketCount = phf->bucketCount;
+    uint32_t slotCount = phf->slotCount;
+
+    memset(bucketStart, 0, (bucketCount + 1) * sizeof(uint32_t));
+    for (uint32_t i = 0; i < count; i++) {
+        mixed[i] = zini_mix(hashes[i] ^ phf->seed);
+        bucketStart[zini_phf_bucket(mixed[i], bucketCount) + 1]++;
+    }
+    uint32_t largest = 0;
+    for (uint32_t b = 0; b < bucketCount; b++) {
+        if (bucketStart[b + 1] > largest) largest = bucketStart[b + 1];
+        bucketStart[b + 1] += bucketStart[b];
+    }
+
+    // members grouped by bucket, using order as the fill cursor for now
+    memcpy(order, bucketStart, bucketCount * sizeof(uint32_t));
+    for (uint32_t i = 0; i < count; i++) members[order[zini_phf_bucket(mixed[i], bucketCount)]++] = i;
+
+    // buckets sorted by size, largest first, with a counting sort
+    uint32_t* sizeStart = (uint32_t*)calloc((size_t)largest + 2, sizeof(uint32_t));
+    if (!sizeStart) return false;
+    for (uint32_t b = 0; b < bucketCount; b++) sizeStart[largest - (bucketStart[b + 1] - bucketStart[b]) + 1]++;
+    for (uint32_t size = 0; size <= largest; size++) sizeStart[size + 1] += sizeStart[size];
+    for (uint32_t b = 0; b < bucketCount; b++) order[sizeStart[largest - (bucketStart[b + 1] - bucketStart[b])]++] = b;
+    free(sizeStart);
+
+    // trying pilots only touches a bitmap of taken slots, small enough to stay in cache
+    uint64_t* taken = (uint64_t*)calloc(slotCount / 64 + 1, sizeof(uint64_t));
+    if (!taken) return false;
+    for (uint32_t i = 0; i < slotCount; i++) phf->slots[i] = UINT32_MAX;
+
+    // with the spare slots a bucket rarely needs more than a few thousand pilots, so this only stops a
+    // seed that cannot work, such as one where two entries of a bucket share their hash
+    const uint64_t limit = 1 << 20;
+
+    bool ok = true;
+    for (uint32_t o = 0; o < bucketCount && ok; o++) {
+        uint32_t bucket = order[o];
+        uint32_t first = bucketStart[bucket];
+        uint32_t size = bucketStart[bucket + 1] - first;
+        phf->pilots[bucket] = 0;
+        if (!size) continue;
+
+        ok = false;
+        for (uint64_t pilot = 0; pilot < limit && !ok; pilot++) {
+            uint32_t j = 0;
+            for (; j < size; j++) {
+                uint32_t position = zini_phf_position(mixed[members[first + j]], (uint32_t)pilot, slotCount);
+                uint64_t bit = 1ULL << (position & 63);
+                if (taken[position >> 6] & bit) break;
+                taken[position >> 6] |= bit;
+            }
+            if (j == size) {
+                phf->pilots[bucket] = (uint32_t)pilot;
+                ok = true;
+            }
+            else {
+                while (j--) {
+                    uint32_t position = zini_phf_position(mixed[members[first + j]], (uint32_t)pilot, slotCount);
+                    taken[position >> 6] &= ~(1ULL << (position & 63));
+                }
+            }
+        }
+    }
+
+    for (uint32_t b = 0; b < bucketCount && ok; b++) {
+        for (uint32_t m = bucketStart[b]; m < bucketStart[b + 1]; m++) {
+            phf->slots[zini_phf_position(mixed[members[m]], phf->pilots[b], slotCount)] = members[m];
+        }
+    }
+    free(taken);
+    return ok;
+}
+
+static uint32_t zini_phf_bucket_count(uint32_t count) {
+    return count / ZINI_PHF_BUCKET_SIZE + 1;
+}
+
+static uint32_t zini_phf_slot_count(uint32_t count) {
+    return count + count / ZINI_PHF_SPARE_SLOTS + 1;
+}
+
+/*
+ * Builds a perfect hash over count distinct hashes, so entry i ends up alone in slot
+ * zini_phf_slot(..., hashes[i]). count must leave room for the spare slots below UINT32_MAX.
+ */
+static bool zini_phf_build(ZINI_PerfectHash* phf, const uint64_t* hashes, uint32_t count) {
+    phf->bucketCount = zini_phf_bucket_count(count);
+    phf->slotCount = zini_phf_slot_count(count);
+    phf->pilots = (uint32_t*)malloc(phf->bucketCount * sizeof(uint32_t));
+    phf->slots = (uint32_t*)malloc(phf->slotCount * sizeof(uint32_t));
+
+    uint64_t* mixed = (uint64_t*)malloc((count ? count : 1) * sizeof(uint64_t));
+    uint32_t* bucketStart = (uint32_t*)malloc((phf->bucketCount + 1) * sizeof(uint32_t));
+    uint32_t* members = (uint32_t*)malloc((count ? count : 1) * sizeof(uint32_t));
+    uint32_t* order = (uint32_t*)malloc(phf->bucketCount * sizeof(uint32_t));
+
+    bool ok = false;
+    if (phf->pilots && phf->slots && mixed && bucketStart && members && order) {
+        for (int attempt = 0; attempt < ZINI_PHF_ATTEMPTS && !ok; attempt++) {
+            phf->seed = zini_mix(0x5A494E49ULL + (uint64_t)attempt);
+            ok = zini_phf_place(phf, hashes, count, mixed, bucketStart, members, order);
+        }
+        if (!ok) fprintf(stderr, "Failed to build perfect hash!\n");
+    }
+    else {
+        perror("Failed to allocate memory for perfect hash");
+    }
+
+    free(mixed);
+    free(bucketStart);
+    free(members);
+    free(order);
+    if (!ok) zini_phf_free(phf);
+    return ok;
+}
+
+static bool zini_reserve_sections(INIFILE* iniFile, size_t capacity) {
+    if (capacity <= iniFile->sectionCapacity) return true;
+
+    Section* newptr = (Section*)realloc(iniFile->sections, capacity * sizeof(Section));
+    if (!newptr) {
+        perror("Failed to allocate memory for sections");
+        return false;
+    }
+
+    iniFile->sections = newptr;
+    iniFile->sectionCapacity = capacity;
+    return true;
+}
+
+static bool zini_reserve_pairs(Section* section, size_t capacity) {
+    if (capacity <= section->pairCapacity) return true;
+
+    Pair* newptr = (Pair*)realloc(section->pairs, capacity * sizeof(Pair));
+    if (!newptr) {
+        perror("Failed to allocate memory for pairs");
+        return false;
+    }
+
+    section->pairs = newptr;
+    section->pairCapacity = capacity;
+    section->owner->generation++;
+    return true;
+}
+
+// doubles the capacity so a run of n inserts costs O(n) copies in total
+static size_t zini_grow_capacity(size_t capacity) {
+    return capacity ? capacity * 2 : ZINI_ARRAY_MIN_CAPACITY;
+}
+
+static bool zini_build_pair_index(Section* section) {
+    for (size_t i = 0; i < section->pairCount; i++) {
+        const Pair* pair = &section->pairs[i];
+        if (!zini_index_insert(&section->pairIndex, zini_hash(pair->key, pair->keyLength), i)) {
+            zini_index_free(&section->pairIndex);
+            return false;
+        }
+    }
+    return true;
+}
+
+static Section* zini_find_section_n(INIFILE* iniFile, const char* name, size_t length) {
+    const ZINI_Index* index = &iniFile->sectionIndex;
+    if (!index->capacity) return NULL;
+
+    uint64_t hash = zini_hash(name, length);
+    size_t mask = index->capacity - 1;
+    for (size_t i = hash & mask; index->slots[i].position; i = (i + 1) & mask) {
+        if (index->slots[i].hash != hash) continue;
+        Section* candidate = &iniFile->sections[index->slots[i].position - 1];
+        if (candidate->sectionLength == length && memcmp(candidate->section, name, length) == 0) return candidate;
+    }
+    return NULL;
+}
+
+static Pair* zini_find_pair_n(Section* section, const char* key, size_t length) {
+    const ZINI_Index* index = &section->pairIndex;
+    if (!index->capacity) {
+        for (size_t i = 0; i < section->pairCount; i++) {
+            const Pair* pair = &section->pairs[i];
+            if (pair->keyLength == length && memcmp(pair->key, key, length) == 0) return &section->pairs[i];
+        }
+        return NULL;
+    }
+
+    uint64_t hash = zini_hash(key, length);
+    size_t mask = index->capacity - 1;
+    for (size_t i = hash & mask; index->slots[i].position; i = (i + 1) & mask) {
+        if (index->slots[i].hash != hash) continue;
+        Pair* candidate = &section->pairs[index->slots[i].position - 1];
+        if (candidate->keyLength == length && memcmp(candidate->key, key, length) == 0) return candidate;
+    }
+    return NULL;
+}
+
+static Pair* zini_find_pair(Section* section, const char* key) {
+    return zini_find_pair_n(section, key, strlen(key));
+}
+
+static void zini_path_free(ZINI_PathIndex* index) {
+    free(index->slots);
+    index->slots = NULL;
+    index->capacity = 0;
+    index->count = 0;
+}
+
+static bool zini_path_resize(ZINI_PathIndex* index, size_t capacity) {
+    ZINI_PathSlot* slots = (ZINI_PathSlot*)calloc(capacity, sizeof(ZINI_PathSlot));
+    if (!slots) {
+        perror("Failed to allocate memory for index");
+        return false;
+    }
+
+    size_t mask = capacity - 1;
+    for (size_t i = 0; i < index->capacity; i++) {
+        if (!index->slots[i].section) continue;
+        size_t j = index->slots[i].hash & mask;
+        while (slots[j].section) j = (j + 1) & mask;
+        slots[j] = index->slots[i];
+    }
+
+    free(index->slots);
+    index->slots = slots;
+    index->capacity = capacity;
+    return true;
+}
+
+// same load factor as zini_index_insert, positions beyond 32 bits cannot be indexed
+static bool zini_path_insert(ZINI_PathIndex* index, uint64_t hash, size_t section, size_t pair) {
+    if (section >= UINT32_MAX || pair > UINT32_MAX) return false;
+    if ((index->count + 1) * 2 > index->capacity) {
+        size_t capacity = index->capacity ? index->capacity * 2 : ZINI_INDEX_MIN_CAPACITY;
+        if (!zini_path_resize(index, capacity)) return false;
+    }
+
+    size_t mask = index->capacity - 1;
+    size_t i = hash & mask;
+    while (index->slots[i].section) i = (i + 1) & mask;
+    index->slots[i].hash = hash;
+    index->slots[i].section = (uint32_t)(section + 1);
+    index->slots[i].pair = (uint32_t)pair;
+    index->count++;
+    return true;
+}
+
+// backward-shift deletion, as in zini_index_remove
+static void zini_path_remove(ZINI_PathIndex* index, uint64_t hash, size_t section, size_t pair) {
+    if (!index->capacity) return;
+
+    size_t mask = index->capacity - 1;
+    size_t i = hash & mask;
+    while (index->slots[i].section != section + 1 || index->slots[i].pair != pair) {
+        if (!index->slots[i].section) return;
+        i = (i + 1) & mask;
+    }
+
+    for (size_t j = (i + 1) & mask; index->slots[j].section; j = (j + 1) & mask) {
+        size_t home = index->slots[j].hash & mask;
+        bool reachable = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+        if (!reachable) {
+            index->slots[i] = index->slots[j];
+            i = j;
+        }
+    }
+
+    index->slots[i].section = 0;
+    index->count--;
+}
+
+static void zini_path_move(ZINI_PathIndex* index, uint64_t hash, size_t section, size_t from, size_t to) {
+    if (!index->capacity) return;
+
+    size_t mask = index->capacity - 1;
+    for (size_t i = hash & mask; index->slots[i].section; i = (i + 1) & mask) {
+        if (index->slots[i].section == section + 1 && index->slots[i].pair == from) {
+            index->slots[i].pair = (uint32_t)to;
+            return;
+        }
+    }
+}
+
+static bool zini_build_path_index(INIFILE* iniFile) {
+    ZINI_PathIndex* index = &iniFile->pathIndex;
+    size_t count = 0;
+    for (size_t i = 0; i < iniFile->sectionCount; i++) count += iniFile->sections[i].pairCount;
+
+    size_t capacity = ZINI_INDEX_MIN_CAPACITY;
+    while (count * 2 > capacity) capacity *= 2;
+    if (!zini_path_resize(index, capacity)) return false;
+
+    for (size_t i = 0; i < iniFile->sectionCount; i++) {
+        const Section* section = &iniFile->sections[i];
+        uint64_t sectionHash = zini_hash(section->section, section->sectionLength);
+        for (size_t j = 0; j < section->pairCount; j++) {
+            const Pair* pair = &section->pairs[j];
+            if (!zini_path_insert(index, zini_pair_hash(sectionHash, pair->key, pair->keyLength), i, j)) {
+                zini_path_free(index);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// a pair of a section is indexed under the same hash whatever its position
+static uint64_t zini_path_hash(const Section* section, const Pair* pair) {
+    return zini_pair_hash(zini_hash(section->section, section->sectionLength), pair->key, pair->keyLength);
+}
+
+// with borrow set the name must be NUL-terminated and outlive the INIFILE, it is used without copying
+static Section* zini_add_section_n(INIFILE* iniFile, const char* name, size_t length, bool borrow) {
+    if (iniFile->sectionCount == iniFile->sectionCapacity &&
+        !zini_reserve_sections(iniFile, zini_grow_capacity(iniFile->sectionCapacity))) return NULL;
+
+    const char* copy = borrow ? name : zini_arena_strndup(iniFile, name, length);
+    if (!copy) return NULL;
+
+    if (!zini_index_insert(&iniFile->sectionIndex, zini_hash(name, length), iniFile->sectionCount)) return NULL;
+
+    Section *newSection = &iniFile->sections[iniFile->sectionCount++];
+    newSection->section = copy;
+    newSection->sectionLength = length;
+    newSection->owner = iniFile;
+    newSection->pairs = NULL;
+    newSection->pairCount = 0;
+    newSection->pairCapacity = 0;
+    newSection->pairIndex.slots = NULL;
+    newSection->pairIndex.capacity = 0;
+    newSection->pairIndex.count = 0;
+    newSection->isModified = true;
+    newSection->sourceOffset = ZINI_NO_SOURCE;
+    newSection->sourceLength = 0;
+    if (iniFile->pairReserve) zini_reserve_pairs(newSection, iniFile->pairReserve);
+    iniFile->isModified = true;
+    return newSection;
+}
+
+static Pair* zini_add_pair_n(Section* section, const char* key, size_t keyLength, const char* value, size_t valueLength, bool borrow) {
+    if (section->pairCount == section->pairCapacity &&
+        !zini_reserve_pairs(section, zini_grow_capacity(section->pairCapacity))) return NULL;
+
+    INIFILE* iniFile = section->owner;
+    const char* keyCopy = borrow ? key : zini_arena_strndup(iniFile, key, keyLength);
+    const char* valueCopy = borrow ? value : zini_arena_strndup(iniFile, value, valueLength);
+    if (!keyCopy || !valueCopy) return NULL;
+
+    Pair* newPair = &section->pairs[section->pairCount++];
+    newPair->key = keyCopy;
+    newPair->keyLength = keyLength;
+    newPair->value = valueCopy;
+    newPair->valueLength = valueLength;
+    newPair->isModified = true;
+    newPair->cacheType = ZINI_CACHE_NONE;
+
+    // a pair index that missed a pair would hide it, so one that cannot take it falls back to the linear scan
+    if (section->pairIndex.capacity) {
+        if (!zini_index_insert(&section->pairIndex, zini_hash(key, keyLength), section->pairCount - 1)) {
+            zini_index_free(&section->pairIndex);
+        }
+    }
+    else if (section->pairCount > ZINI_PAIR_INDEX_THRESHOLD) {
+        zini_build_pair_index(section);
+    }
+    // a path index that missed a pair would answer wrongly, so one that cannot take it is rebuilt later
+    if (iniFile->pathIndex.capacity &&
+        !zini_path_insert(&iniFile->pathIndex, zini_path_hash(section, newPair),
+                          (size_t)(section - iniFile->sections), section->pairCount - 1)) {
+        zini_path_free(&iniFile->pathIndex);
+    }
+    section->isModified = true;
+    iniFile->isModified = true;
+    return newPair;
+}
+
+// the one delimiter a line can need, newline for lines that have none
+static char zini_line_delimiter(char first) {
+    if (first == '[') return ']';
+    if (first == ';') return '\n';
+    return '=';
+}
+
+static char* zini_scan_bytes(char* cursor, char* end, char delimiter, char** found) {
+    for (; cursor < end; cursor++) {
+        if (*cursor == '\n') return cursor;
+        if (*cursor == delimiter && !*found) *found = cursor;
+    }
+    return NULL;
+}
+
+/*
+ * Finds the end of the line starting at cursor and the first delimiter on it in a single pass,
+ * 16 bytes at a time with SSE2 and 8 bytes at a time with SWAR elsewhere. Returns the newline,
+ * or end when the line is not terminated.
+ */
+static char* zini_scan_line(char* cursor, char* end, char delimiter, char** found) {
+    *found = NULL;
+
+#if ZINI_HAVE_SSE2
+    const __m128i newlines = _mm_set1_epi8('\n');
+    const __m128i delimiters = _mm_set1_epi8(delimiter);
+    while (end - cursor >= 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)cursor);
+        unsigned newlineMask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(block, newlines));
+        unsigned delimiterMask = *found ? 0 : (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(block, delimiters));
+        if (delimiterMask) {
+            unsigned first = (unsigned)__builtin_ctz(delimiterMask);
+            if (!newlineMask || first < (unsigned)__builtin_ctz(newlineMask)) *found = cursor + first;
+        }
+        if (newlineMask) return cursor + __builtin_ctz(newlineMask);
+        cursor += 16;
+    }
+#else
+    const uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t highs = 0x8080808080808080ULL;
+    const uint64_t newlines = ones * (unsigned char)'\n';
+    const uint64_t delimiters = ones * (unsigned char)delimiter;
+    while (end - cursor >= 8) {
+        uint64_t word;
+        memcpy(&word, cursor, sizeof(word));
+        uint64_t hits = ((word ^ newlines) - ones) & ~(word ^ newlines);
+        if (!*found) hits |= ((word ^ delimiters) - ones) & ~(word ^ delimiters);
+        if (hits & highs) {
+            char* newline = zini_scan_bytes(cursor, cursor + 8, delimiter, found);
+            if (newline) return newline;
+        }
+        cursor += 8;
+    }
+#endif // ZINI_HAVE_SSE2
+
+    char* newline = zini_scan_bytes(cursor, end, delimiter, found);
+    return newline ? newline : end;
+}
+
+typedef enum {
+    ZINI_LINE_NONE,
+    ZINI_LINE_COMMENT,
+    ZINI_LINE_SECTION,
+    ZINI_LINE_PAIR
+} ZINI_LineType;
+
+// the dialect in one place: ';' starts a comment, "[name]" a section, "key=value" a pair, anything else is skipped
+static ZINI_LineType zini_classify_line(const char* line, size_t length, const char* delimiter) {
+    if (length == 0) return ZINI_LINE_NONE;
+    if (line[0] == ';') return ZINI_LINE_COMMENT;
+    if (!delimiter) return ZINI_LINE_NONE;
+    return line[0] == '[' ? ZINI_LINE_SECTION : ZINI_LINE_PAIR;
+}
+
+typedef struct {
+    INIFILE* iniFile;
+    Section* currentSection;
+    size_t openSection;     // position + 1 of the section whose source span is still open, 0 for none
+    bool spliceable;        // false once a section header repeats, its pairs then have no single span
+} ZINI_LoadState;
+
+static void zini_load_begin(ZINI_LoadState* state, INIFILE* iniFile) {
+    state->iniFile = iniFile;
+    state->currentSection = NULL;
+    state->openSection = 0;
+    state->spliceable = true;
+}
+
+// a section's span runs from its header to the next header, comments and blank lines included
+static void zini_close_span(ZINI_LoadState* state, size_t offset) {
+    if (!state->openSection) return;
+    Section* section = &state->iniFile->sections[state->openSection - 1];
+    section->sourceLength = offset - section->sourceOffset;
+    state->openSection = 0;
+}
+
+// records the layout of the source for ZINI_SaveIncremental, size is the number of bytes parsed
+static void zini_load_end(ZINI_LoadState* state, size_t size) {
+    zini_close_span(state, size);
+    state->iniFile->sourceSize = state->spliceable ? size : ZINI_NO_SOURCE;
+}
+
+// what was just loaded matches its source, so nothing is dirty
+static void zini_mark_clean(INIFILE* iniFile) {
+    for (size_t i = 0; i < iniFile->sectionCount; i++) {
+        Section* section = &iniFile->sections[i];
+        section->isModified = false;
+        for (size_t j = 0; j < section->pairCount; j++) section->pairs[j].isModified = false;
+    }
+    iniFile->isModified = false;
+    iniFile->removedSource = ZINI_NO_SOURCE;
+}
+
+/*
+ * Handles one line of input, without its newline, starting at byte offset of the source. delimiter is
+ * the first byte on the line matching zini_line_delimiter, or NULL. With borrow set the line is parsed
+ * in place: line[length] must be writable, NULs are written over the delimiters, and the new sections
+ * and pairs point into the line. Otherwise the line is left untouched and its pieces are copied.
+ */
+static void zini_parse_line(ZINI_LoadState* state, char* line, size_t length, char* delimiter, size_t offset, bool borrow) {
+    INIFILE* iniFile = state->iniFile;
+
+    switch (zini_classify_line(line, length, delimiter)) {
+        case ZINI_LINE_SECTION: {
+            zini_close_span(state, offset);
+
+            const char* name = line + 1;
+            size_t nameLength = (size_t)(delimiter - name);
+            Section* section = zini_find_section_n(iniFile, name, nameLength);
+            if (section) {
+                state->spliceable = false;
+            }
+            else {
+                if (borrow) *delimiter = '\0';
+                section = zini_add_section_n(iniFile, name, nameLength, borrow);
+                if (section) {
+                    section->sourceOffset = offset;
+                    state->openSection = (size_t)(section - iniFile->sections) + 1;
+                }
+            }
+            state->currentSection = section;
+            break;
+        }
+        case ZINI_LINE_PAIR: {
+            Section* section = state->currentSection;
+            if (!section) break;
+
+            size_t keyLength = (size_t)(delimiter - line);
+            if (zini_find_pair_n(section, line, keyLength)) {
+                fprintf(stderr, "Key Exist!\n");
+                break;
+            }
+
+            if (borrow) {
+                *delimiter = '\0';
+                line[length] = '\0';
+            }
+            zini_add_pair_n(section, line, keyLength, delimiter + 1, length - keyLength - 1, borrow);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+/*
+ * Parses a whole buffer in place, only a last line without newline is copied since it cannot be
+ * terminated. baseOffset is the position of the buffer within its source file.
+ */
+static void zini_parse_buffer(INIFILE* iniFile, char* data, size_t length, size_t baseOffset) {
+    ZINI_LoadState state;
+    zini_load_begin(&state, iniFile);
+
+    char* end = data + length;
+    char* line = data;
+    while (line < end) {
+        char* delimiter;
+        char* newline = zini_scan_line(line, end, zini_line_delimiter(*line), &delimiter);
+        zini_parse_line(&state, line, (size_t)(newline - line), delimiter, baseOffset + (size_t)(line - data), newline != end);
+        line = newline + 1;
+    }
+
+    zini_load_end(&state, baseOffset + length);
+    zini_mark_clean(iniFile);
+}
+
+typedef bool (*ZINI_LineHandler)(void* context, char* line, size_t length, char* delimiter, size_t offset);
+
+/*
+ * Reads whole lines through one reusable window of ZINI_PARSE_WINDOW bytes, handing each to the handler
+ * with line[length] writable. The window only grows, by doubling, when a single line needs more room,
+ * so lines of any length are read intact without an allocation per line. The number of bytes read is
+ * stored in total when it is not NULL.
+ */
+static bool zini_read_lines(FILE* source, ZINI_LineHandler handler, void* context, size_t* total) {
+    size_t capacity = ZINI_PARSE_WINDOW;
+    // one spare byte, so an unterminated last line can still be terminated in place
+    char* window = (char*)malloc(capacity + 1);
+    if (!window) {
+        perror("Failed to allocate memory for parse window");
+        return false;
+    }
+
+    bool ok = true;
+    size_t filled = 0;
+    size_t consumed = 0;
+
+    while (ok) {
+        // a partial line taking more than half the window would leave too little room per read
+        if (filled > capacity / 2) {
+            char* grown = (char*)realloc(window, capacity * 2 + 1);
+            if (!grown) {
+                perror("Failed to allocate memory for parse window");
+                ok = false;
+                break;
+            }
+            window = grown;
+            capacity *= 2;
+        }
+
+        size_t wanted = capacity - filled;
+        size_t got = fread(window + filled, 1, wanted, source);
+        bool eof = got < wanted;
+        if (eof && ferror(source)) {
+            perror("Error reading INI source");
+            ok = false;
+            break;
+        }
+        filled += got;
+
+        char* line = window;
+        char* end = window + filled;
+        while (ok && line < end) {
+            char* delimiter;
+            char* newline = zini_scan_line(line, end, zini_line_delimiter(*line), &delimiter);
+            if (newline == end && !eof) break;
+            ok = handler(context, line, (size_t)(newline - line), delimiter, consumed + (size_t)(line - window));
+            line = newline + 1;
+        }
+        if (eof || !ok) {
+            consumed += filled;
+            break;
+        }
+
+        // carry the partial line over to the front of the window
+        size_t rest = line < end ? (size_t)(end - line) : 0;
+        consumed += filled - rest;
+        filled = rest;
+        memmove(window, line, filled);
+    }
+
+    if (total) *total = consumed;
+    free(window);
+    return ok;
+}
+
+void ZINI_Init(INIFILE *iniFile) {
+    if (!iniFile) return;
+    iniFile->sections = NULL;
+    iniFile->sectionCount = 0;
+    iniFile->sectionCapacity = 0;
+    iniFile->pairReserve = 0;
+    iniFile->isModified = false;
+    iniFile->sectionIndex.slots = NULL;
+    iniFile->sectionIndex.capacity = 0;
+    iniFile->sectionIndex.count = 0;
+    iniFile->arena = NULL;
+    iniFile->mapping = NULL;
+    iniFile->mappingLength = 0;
+    memset(&iniFile->mappingFile, 0, sizeof(iniFile->mappingFile));
+    iniFile->sourceSize = ZINI_NO_SOURCE;
+    memset(&iniFile->sourceFile, 0, sizeof(iniFile->sourceFile));
+    iniFile->floatFormat = ZINI_FORMAT_FIXED;
+    iniFile->frozen = NULL;
+    iniFile->pathIndex.slots = NULL;
+    iniFile->pathIndex.capacity = 0;
+    iniFile->pathIndex.count = 0;
+    iniFile->generation = 0;
+    iniFile->removedSource = ZINI_NO_SOURCE;
+}
+
+#ifdef ZINI_HAVE_MMAP
+static ZINI_FileStamp zini_file_stamp(const struct stat* info) {
+    ZINI_FileStamp stamp;
+    stamp.device = (uint64_t)info->st_dev;
+    stamp.inode = (uint64_t)info->st_ino;
+#ifdef __APPLE__
+    stamp.modified = (int64_t)info->st_mtimespec.tv_sec * 1000000000 + info->st_mtimespec.tv_nsec;
+#else
+    stamp.modified = (int64_t)info->st_mtim.tv_sec * 1000000000 + info->st_mtim.tv_nsec;
+#endif // __APPLE__
+    return stamp;
+}
+
+// the same version of the same file, a rewrite of the same size still changes the modification time
+static bool zini_same_version(ZINI_FileStamp a, ZINI_FileStamp b) {
+    return a.device == b.device && a.inode == b.inode && a.modified == b.modified;
+}
+#endif // ZINI_HAVE_MMAP
+
+static bool zini_load_line(void* context, char* line, size_t length, char* delimiter, size_t offset) {
+    zini_parse_line((ZINI_LoadState*)context, line, length, delimiter, offset, false);
+    return true;
+}
+
+bool ZINI_Open(INIFILE* iniFile, const char* filename) {
+    if (!iniFile || !filename) {
+        fprintf(stderr, "INI file or file name is NULL!\n");
+        return false;
+    }
+
+    ZINI_Init(iniFile);
+
+    FILE *file = fopen(filename, "r");
+    if (!file) {
+        if (errno == ENOENT) return true;
+        perror("Error opening INI file");
+        return false;
+    }
+
+#ifdef ZINI_HAVE_MMAP
+    struct stat info;
+    if (fstat(fileno(file), &info) == 0) iniFile->sourceFile = zini_file_stamp(&info);
+#endif // ZINI_HAVE_MMAP
+
+    ZINI_LoadState state;
+    zini_load_begin(&state, iniFile);
+    size_t size;
+    bool ok = zini_read_lines(file, zini_load_line, &state, &size);
+    fclose(file);
+
+    zini_load_end(&state, size);
+    zini_mark_clean(iniFile);
+    return ok;
+}
+
+/*
+ * Maps a file privately and writably, or reads it into the arena where mmap is not available.
+ * *data is left NULL for a missing or empty file, which callers treat as an empty INI file.
+ */
+static bool zini_load_file(INIFILE* iniFile, const char* filename, char** data, size_t* length) {
+    *data = NULL;
+    *length = 0;
+
+#ifdef ZINI_HAVE_MMAP
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        if (errno == ENOENT) return true;
+        perror("Error opening INI file");
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        perror("Error reading INI file size");
+        close(fd);
+        return false;
+    }
+    iniFile->sourceFile = zini_file_stamp(&info);
+
+    size_t size = (size_t)info.st_size;
+    if (size == 0) {
+        close(fd);
+        return true;
+    }
+
+    // private and writable, so the parser can terminate strings in place without touching the file. Every
+    // page holds a newline that becomes a NUL, so the whole file ends up copied on write into private memory
+    void* mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        perror("Error mapping INI file");
+        return false;
+    }
+    posix_madvise(mapping, size, POSIX_MADV_SEQUENTIAL);
+
+    iniFile->mapping = mapping;
+    iniFile->mappingLength = size;
+    iniFile->mappingFile = iniFile->sourceFile;
+    *data = (char*)mapping;
+    *length = size;
+    return true;
+#else
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+        if (errno == ENOENT) return true;
+        perror("Error opening INI file");
+        return false;
+    }
+
+    if (fseek(file, 0, SEEK_END) != 0) {
+        perror("Error reading INI file size");
+        fclose(file);
+        return false;
+    }
+    long size = ftell(file);
+    rewind(file);
+    if (size <= 0) {
+        fclose(file);
+        return size == 0;
+    }
+
+    // the buffer lives in the arena, so ZINI_Clean releases it with the rest of the strings
+    char* buffer = zini_arena_alloc(iniFile, (size_t)size);
+    if (!buffer || fread(buffer, 1, (size_t)size, file) != (size_t)size) {
+        if (buffer) perror("Error reading INI file");
+        fclose(file);
+        return false;
+    }
+    fclose(file);
+
+    *data = buffer;
+    *length = (size_t)size;
+    return true;
+#endif // ZINI_HAVE_MMAP
+}
+
+bool ZINI_OpenMapped(INIFILE* iniFile, const char* filename) {
+    if (!iniFile || !filename) {
+        fprintf(stderr, "INI file or file name is NULL!\n");
+        return false;
+    }
+
+    ZINI_Init(iniFile);
+
+    char* data;
+    size_t length;
+    if (!zini_load_file(iniFile, filename, &data, &length)) return false;
+    if (data) zini_parse_buffer(iniFile, data, length, 0);
+    return true;
+}
+
+#ifdef ZINI_HAVE_PTHREADS
+typedef struct {
+    INIFILE local;
+    char* data;
+    size_t length;
+    size_t offset;
+} ZINI_ParseChunk;
+
+static void* zini_parse_chunk(void* arg) {
+    ZINI_ParseChunk* chunk = (ZINI_ParseChunk*)arg;
+    zini_parse_buffer(&chunk->local, chunk->data, chunk->length, chunk->offset);
+    return NULL;
+}
+
+/*
+ * Folds a chunk into the result, applying the serial rules: repeated sections merge, the first copy of
+ * a key wins. Returns false when a section repeats, since the source layout can then not be spliced.
+ */
+static bool zini_merge_chunk(INIFILE* iniFile, INIFILE* local) {
+    bool spliceable = local->sourceSize != ZINI_NO_SOURCE;
+    for (size_t i = 0; i < local->sectionCount; i++) {
+        const Section* source = &local->sections[i];
+        Section* target = zini_find_section_n(iniFile, source->section, source->sectionLength);
+        if (target) {
+            spliceable = false;
+        }
+        else {
+            target = zini_add_section_n(iniFile, source->section, source->sectionLength, true);
+            if (!target) continue;
+            target->sourceOffset = source->sourceOffset;
+            target->sourceLength = source->sourceLength;
+        }
+
+        for (size_t j = 0; j < source->pairCount; j++) {
+            const Pair* pair = &source->pairs[j];
+            if (zini_find_pair_n(target, pair->key, pair->keyLength)) {
+                fprintf(stderr, "Key Exist!\n");
+                continue;
+            }
+            zini_add_pair_n(target, pair->key, pair->keyLength, pair->value, pair->valueLength, true);
+        }
+    }
+
+    // strings copied into the chunk's arena are still referenced, hand its blocks over
+    ZINI_ArenaBlock* tail = local->arena;
+    if (tail) {
+        while (tail->next) tail = tail->next;
+        tail->next = iniFile->arena;
+        iniFile->arena = local->arena;
+        local->arena = NULL;
+    }
+
+    local->isModified = false;
+    ZINI_Clean(local);
+    return spliceable;
+}
+#endif // ZINI_HAVE_PTHREADS
+
+bool ZINI_OpenParallel(INIFILE* iniFile, const char* filename, int threads) {
+    if (!iniFile || !filename) {
+        fprintf(stderr, "INI file or file name is NULL!\n");
+        return false;
+    }
+
+    ZINI_Init(iniFile);
+
+    char* data;
+    size_t length;
+    if (!zini_load_file(iniFile, filename, &data, &length)) return false;
+    if (!data) return true;
+
+#ifdef ZINI_HAVE_PTHREADS
+    // the cap comes last, it is what keeps the cuts inside the chunk arrays
+    if (threads < 1) threads = 1;
+    if ((size_t)threads > length / ZINI_MIN_PARSE_CHUNK) threads = (int)(length / ZINI_MIN_PARSE_CHUNK);
+    if (threads > ZINI_MAX_PARSE_THREADS) threads = ZINI_MAX_PARSE_THREADS;
+    if (threads > 1) {
+        ZINI_ParseChunk chunks[ZINI_MAX_PARSE_THREADS];
+        pthread_t workers[ZINI_MAX_PARSE_THREADS];
+        bool started[ZINI_MAX_PARSE_THREADS];
+        int count = 0;
+
+        // cut only in front of lines zini_parse_line takes as section headers, so every chunk after the first starts with its section
+        char* start = data;
+        char* end = data + length;
+        for (int t = 1; t < threads && start < end; t++) {
+            char* cut = data + length / threads * t;
+            if (cut < start) cut = start;
+            while (cut < end) {
+                char* newline = (char*)memchr(cut, '\n', (size_t)(end - cut));
+                if (!newline) {
+                    cut = end;
+                    break;
+                }
+                cut = newline + 1;
+                if (cut < end && *cut == '[') {
+                    char* delimiter;
+                    newline = zini_scan_line(cut, end, ']', &delimiter);
+                    if (zini_classify_line(cut, (size_t)(newline - cut), delimiter) == ZINI_LINE_SECTION) break;
+                }
+            }
+            if (cut >= end) break;
+
+            chunks[count].data = start;
+            chunks[count].length = (size_t)(cut - start);
+            chunks[count].offset = (size_t)(start - data);
+            count++;
+            start = cut;
+        }
+        chunks[count].data = start;
+        chunks[count].length = (size_t)(end - start);
+        chunks[count].offset = (size_t)(start - data);
+        count++;
+
+        for (int t = 0; t < count; t++) {
+            ZINI_Init(&chunks[t].local);
+            started[t] = pthread_create(&workers[t], NULL, zini_parse_chunk, &chunks[t]) == 0;
+            if (!started[t]) zini_parse_chunk(&chunks[t]);
+        }
+
+        bool spliceable = true;
+        for (int t = 0; t < count; t++) {
+            if (started[t]) pthread_join(workers[t], NULL);
+            if (!zini_merge_chunk(iniFile, &chunks[t].local)) spliceable = false;
+        }
+
+        iniFile->sourceSize = spliceable ? length : ZINI_NO_SOURCE;
+        zini_mark_clean(iniFile);
+        return true;
+    }
+#else
+    (void)threads;
+#endif // ZINI_HAVE_PTHREADS
+
+    zini_parse_buffer(iniFile, data, length, 0);
+    return true;
+}
+
+bool ZINI_OpenBuffer(INIFILE* iniFile, const char* data, size_t length) {
+    if (!iniFile || !data) {
+        fprintf(stderr, "INI file or data is NULL!\n");
+        return false;
+    }
+
+    ZINI_Init(iniFile);
+    if (length == 0) return true;
+
+    // one copy into the arena, after that the in-place parser borrows from it
+    char* copy = zini_arena_alloc(iniFile, length);
+    if (!copy) return false;
+    memcpy(copy, data, length);
+
+    // there is no file behind the data, so there is nothing for ZINI_SaveIncremental to splice into
+    zini_parse_buffer(iniFile, copy, length, 0);
+    iniFile->sourceSize = ZINI_NO_SOURCE;
+    return true;
+}
+
+bool ZINI_OpenBufferInPlace(INIFILE* iniFile, char* data, size_t length) {
+    if (!iniFile || !data) {
+        fprintf(stderr, "INI file or data is NULL!\n");
+        return false;
+    }
+
+    ZINI_Init(iniFile);
+    zini_parse_buffer(iniFile, data, length, 0);
+    iniFile->sourceSize = ZINI_NO_SOURCE;
+    return true;
+}
+
+bool ZINI_OpenString(INIFILE* iniFile, const char* data) {
+    if (!iniFile || !data) {
+        fprintf(stderr, "INI file or data is NULL!\n");
+        return false;
+    }
+
+    return ZINI_OpenBuffer(iniFile, data, strlen(data));
+}
+
+// line[length] must be writable, the pieces handed to the callbacks are terminated in place
+static bool zini_emit_line(const ZINI_Callbacks* callbacks, void* userdata, bool* inSection,
+                           char* line, size_t length, char* delimiter) {
+    switch (zini_classify_line(line, length, delimiter)) {
+        case ZINI_LINE_COMMENT:
+            if (!callbacks->onComment) return true;
+            line[length] = '\0';
+            return callbacks->onComment(userdata, line + 1, length - 1);
+        case ZINI_LINE_SECTION:
+            *inSection = true;
+            if (!callbacks->onSection) return true;
+            *delimiter = '\0';
+            return callbacks->onSection(userdata, line + 1, (size_t)(delimiter - line - 1));
+        case ZINI_LINE_PAIR:
+            // pairs in front of the first section are dropped, as ZINI_Open does
+            if (!*inSection || !callbacks->onPair) return true;
+            *delimiter = '\0';
+            line[length] = '\0';
+            return callbacks->onPair(userdata, line, (size_t)(delimiter - line),
+                                     delimiter + 1, length - (size_t)(delimiter - line) - 1);
+        default:
+            return true;
+    }
+}
+
+typedef struct {
+    const ZINI_Callbacks* callbacks;
+    void* userdata;
+    bool inSection;
+} ZINI_StreamState;
+
+static bool zini_stream_line(void* context, char* line, size_t length, char* delimiter, size_t offset) {
+    (void)offset;
+    ZINI_StreamState* state = (ZINI_StreamState*)context;
+    return zini_emit_line(state->callbacks, state->userdata, &state->inSection, line, length, delimiter);
+}
+
+bool ZINI_Parse(FILE* source, const ZINI_Callbacks* callbacks, void* userdata) {
+    if (!source || !callbacks) {
+        fprintf(stderr, "Source or callbacks is NULL!\n");
+        return false;
+    }
+
+    ZINI_StreamState state = { callbacks, userdata, false };
+    return zini_read_lines(source, zini_stream_line, &state, NULL);
+}
+
+static size_t zini_rendered_section_length(const Section* section) {
+    size_t length = section->sectionLength + 4; // "[", "]\n" and the blank line after the pairs
+    for (size_t j = 0; j < section->pairCount; j++) {
+        length += section->pairs[j].keyLength + section->pairs[j].valueLength + 2;
+    }
+    return length;
+}
+
+static char* zini_render_section(const Section* section, char* out) {
+    *out++ = '[';
+    memcpy(out, section->section, section->sectionLength);
+    out += section->sectionLength;
+    *out++ = ']';
+    *out++ = '\n';
+    for (size_t j = 0; j < section->pairCount; j++) {
+        const Pair* pair = &section->pairs[j];
+        memcpy(out, pair->key, pair->keyLength);
+        out += pair->keyLength;
+        *out++ = '=';
+        memcpy(out, pair->value, pair->valueLength);
+        out += pair->valueLength;
+        *out++ = '\n';
+    }
+    *out++ = '\n';
+    return out;
+}
+
+// renders the whole file into one buffer, sized exactly by a first pass over the lengths
+static char* zini_render(const INIFILE* iniFile, size_t* length) {
+    size_t total = 0;
+    for (size_t i = 0; i < iniFile->sectionCount; i++) {
+        total += zini_rendered_section_length(&iniFile->sections[i]);
+    }
+
+    char* buffer = (char*)malloc(total ? total : 1);
+    if (!buffer) {
+        perror("Failed to allocate memory for INI output");
+        return NULL;
+    }
+
+    char* out = buffer;
+    for (size_t i = 0; i < iniFile->sectionCount; i++) {
+        out = zini_render_section(&iniFile->sections[i], out);
+    }
+
+    *length = total;
+    return buffer;
+}
+
+// after a full save the file holds exactly what zini_render produced, so that becomes the new layout
+static void zini_adopt_layout(INIFILE* iniFile, ZINI_FileStamp written) {
+    size_t offset = 0;
+    for (size_t i = 0; i < iniFile->sectionCount; i++) {
+        Section* section = &iniFile->sections[i];
+        section->sourceOffset = offset;
+        section->sourceLength = zini_rendered_section_length(section);
+        offset += section->sourceLength;
+    }
+
+    iniFile->sourceSize = offset;
+    iniFile->sourceFile = written;
+    zini_mark_clean(iniFile);
+}
+
+#ifdef ZINI_HAVE_MMAP
+static const char* zini_relocate(const char* str, uintptr_t base, size_t length, char* copy) {
+    uintptr_t address = (uintptr_t)str;
+    if (address < base || address >= base + length) return str;
+    return copy + (address - base);
+}
+
+/*
+ * Rewriting or truncating the mapped file would change or revoke the strings that point into the mapping,
+ * even in pages that already have private copies. Before the mapped file is written in place the mapping is
+ * therefore copied into the arena, every string is moved over and the mapping is released.
+ */
+static bool zini_detach_mapping(INIFILE* iniFile) {
+    if (!iniFile->mapping) return true;
+
+    size_t length = iniFile->mappingLength;
+    char* copy = zini_arena_alloc(iniFile, length);
+    if (!copy) return false;
+    memcpy(copy, iniFile->mapping, length);
+
+    uintptr_t base = (uintptr_t)iniFile->mapping;
+    for (size_t i = 0; i < iniFile->sectionCount; i++) {
+        Section* section = &iniFile->sections[i];
+        section->section = zini_relocate(section->section, base, length, copy);
+        for (size_t j = 0; j < section->pairCount; j++) {
+            Pair* pair = &section->pairs[j];
+            pair->key = zini_relocate(pair->key, base, length, copy);
+            pair->value = zini_relocate(pair->value, base, length, copy);
+        }
+    }
+
+    munmap(iniFile->mapping, length);
+    iniFile->mapping = NULL;
+    iniFile->mappingLength = 0;
+    return true;
+}
+
+// writing any other file than the mapped one leaves the strings alone, so only that needs the copy
+static bool zini_detach_mapping_for(INIFILE* iniFile, const struct stat* target) {
+    if (!iniFile->mapping) return true;
+    ZINI_FileStamp stamp = zini_file_stamp(target);
+    if (stamp.device != iniFile->mappingFile.device || stamp.inode != iniFile->mappingFile.inode) return true;
+    return zini_detach_mapping(iniFile);
+}
+
+static bool zini_write_all(int fd, const char* data, size_t length) {
+    while (length) {
+        ssize_t written = write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        length -= (size_t)written;
+    }
+    return true;
+}
+#endif // ZINI_HAVE_MMAP
+
+bool ZINI_Save(INIFILE* iniFile, const char* filename) {
+    if (!iniFile || !filename) {
+        fprintf(stderr, "INI file or file name is NULL!\n");
+        return false;
+    }
+
+    size_t length;
+    char* buffer = zini_render(iniFile, &length);
+    if (!buffer) return false;
+
+    ZINI_FileStamp written;
+    memset(&written, 0, sizeof(written));
+#ifdef ZINI_HAVE_MMAP
+    // truncated only once it is known whether the target is the mapped file
+    int fd = open(filename, O_WRONLY | O_CREAT, 0666);
+    if (fd < 0) {
+        perror("Error opening INI file for writing");
+        free(buffer);
+        return false;
+    }
+
+    struct stat info;
+    bool ok = fstat(fd, &info) == 0 && zini_detach_mapping_for(iniFile, &info) && ftruncate(fd, 0) == 0 &&
+              zini_write_all(fd, buffer, length);
+    if (ok && fstat(fd, &info) == 0) written = zini_file_stamp(&info);
+    if (close(fd) != 0) ok = false;
+#else
+    FILE *file = fopen(filename, "wb");
+    if (!file) {
+        perror("Error opening INI file for writing");
+        free(buffer);
+        return false;
+    }
+
+    bool ok = fwrite(buffer, 1, length, file) == length;
+    if (fclose(file) != 0) ok = false;
+#endif // ZINI_HAVE_MMAP
+
+    free(buffer);
+    if (!ok) {
+        perror("Error writing INI file");
+        return false;
+    }
+
+    zini_adopt_layout(iniFile, written);
+    return true;
+}
+
+#ifdef ZINI_HAVE_MMAP
+// the temp file sits next to the target so the rename stays within one file system
+static char* zini_temp_path(const char* filename) {
+    size_t length = strlen(filename);
+    char* path = (char*)malloc(length + sizeof(".tmpXXXXXX"));
+    if (!path) {
+        perror("Failed to allocate memory for temp file name");
+        return NULL;
+    }
+    memcpy(path, filename, length);
+    memcpy(path + length, ".tmpXXXXXX", sizeof(".tmpXXXXXX"));
+    return path;
+}
+
+// the directory a rename of filename happens in, "." for a bare name, NULL only when out of memory
+static char* zini_directory_of(const char* filename) {
+    const char* slash = strrchr(filename, '/');
+    if (!slash) filename = ".";
+
+    size_t length = !slash || slash == filename ? 1 : (size_t)(slash - filename);
+    char* directory = (char*)malloc(length + 1);
+    if (!directory) {
+        perror("Failed to allocate memory for directory name");
+        return NULL;
+    }
+    memcpy(directory, filename, length);
+    directory[length] = '\0';
+    return directory;
+}
+
+static bool zini_sync_directory(const char* directory) {
+    if (!directory) return false;
+    int fd = open(directory, O_RDONLY);
+    if (fd < 0) return false;
+    bool ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+}
+
+// writes and fsyncs data to a fresh temp file, keeping the target's permissions
+static bool zini_write_temp_data(const char* data, size_t length, const char* filename, char* tempPath) {
+    int fd = mkstemp(tempPath);
+    if (fd < 0) {
+        perror("Error creating temp INI file");
+        return false;
+    }
+
+    struct stat info;
+    bool ok = fchmod(fd, stat(filename, &info) == 0 ? (info.st_mode & 07777) : 0644) == 0 &&
+              zini_write_all(fd, data, length) && fsync(fd) == 0;
+    if (close(fd) != 0) ok = false;
+
+    if (!ok) {
+        perror("Error writing temp INI file");
+        unlink(tempPath);
+    }
+    return ok;
+}
+
+static bool zini_write_temp(INIFILE* iniFile, const char* filename, char* tempPath) {
+    size_t length;
+    char* buffer = zini_render(iniFile, &length);
+    if (!buffer) return false;
+
+    bool ok = zini_write_temp_data(buffer, length, filename, tempPath);
+    free(buffer);
+    return ok;
+}
+#endif // ZINI_HAVE_MMAP
+
+bool ZINI_SaveAtomicBatch(INIFILE** iniFiles, const char** filenames, size_t count) {
+    if (!iniFiles || !filenames) {
+        fprintf(stderr, "INI files or file names is NULL!\n");
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (!iniFiles[i] || !filenames[i]) {
+            fprintf(stderr, "INI file or file name is NULL!\n");
+            return false;
+        }
+    }
+
+#ifdef ZINI_HAVE_MMAP
+    char** tempPaths = (char**)calloc(count ? count : 1, sizeof(char*));
+    char** directories = (char**)calloc(count ? count : 1, sizeof(char*));
+    if (!tempPaths || !directories) {
+        perror("Failed to allocate memory for temp file names");
+        free(tempPaths);
+        free(directories);
+        return false;
+    }
+
+    // every file is written and synced before the first rename, so a failure leaves all targets untouched
+    bool ok = true;
+    size_t written = 0;
+    for (; written < count; written++) {
+        tempPaths[written] = zini_temp_path(filenames[written]);
+        if (!tempPaths[written] || !zini_write_temp(iniFiles[written], filenames[written], tempPaths[written])) {
+            free(tempPaths[written]);
+            ok = false;
+            break;
+        }
+    }
+
+    size_t renamed = 0;
+    for (; ok && renamed < count; renamed++) {
+        if (rename(tempPaths[renamed], filenames[renamed]) != 0) {
+            perror("Error replacing INI file");
+            ok = false;
+            break;
+        }
+        // the renamed temp file is the target now, its stamp is what the next incremental save expects
+        ZINI_FileStamp written;
+        memset(&written, 0, sizeof(written));
+        struct stat info;
+        if (stat(filenames[renamed], &info) == 0) written = zini_file_stamp(&info);
+        zini_adopt_layout(iniFiles[renamed], written);
+    }
+    for (size_t i = renamed; i < written; i++) unlink(tempPaths[i]);
+
+    // one directory fsync per distinct directory makes all the renames durable
+    for (size_t i = 0; i < renamed; i++) {
+        directories[i] = zini_directory_of(filenames[i]);
+        if (!directories[i]) {
+            ok = false;
+            continue;
+        }
+
+        bool seen = false;
+        for (size_t j = 0; j < i && !seen; j++) {
+            seen = directories[j] && strcmp(directories[i], directories[j]) == 0;
+        }
+        if (!seen && !zini_sync_directory(directories[i])) {
+            perror("Error syncing INI file directory");
+            ok = false;
+        }
+    }
+
+    for (size_t i = 0; i < written; i++) free(tempPaths[i]);
+    for (size_t i = 0; i < renamed; i++) free(directories[i]);
+    free(tempPaths);
+    free(directories);
+    return ok;
+#else
+    // without POSIX rename and fsync semantics this degrades to replacing the files one by one
+    for (size_t i = 0; i < count; i++) {
+        if (!ZINI_Save(iniFiles[i], filenames[i])) return false;
+    }
+    return true;
+#endif // ZINI_HAVE_MMAP
+}
+
+bool ZINI_SaveAtomic(INIFILE* iniFile, const char* filename) {
+    return ZINI_SaveAtomicBatch(&iniFile, &filename, 1);
+}
+
+#ifdef ZINI_HAVE_MMAP
+static bool zini_pwrite_all(int fd, const char* data, size_t length, size_t offset) {
+    while (length) {
+        ssize_t written = pwrite(fd, data, length, (off_t)offset);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        length -= (size_t)written;
+        offset += (size_t)written;
+    }
+    return true;
+}
+
+static bool zini_pread_all(int fd, char* data, size_t length, size_t offset) {
+    while (length) {
+        ssize_t got = pread(fd, data, length, (off_t)offset);
+        if (got <= 0) {
+            if (got < 0 && errno == EINTR) continue;
+            return false;
+        }
+        data += got;
+        length -= (size_t)got;
+        offset += (size_t)got;
+    }
+    return true;
+}
+
+// every changed section still renders to exactly its old span, so each one is overwritten where it is
+static bool zini_splice_in_place(INIFILE* iniFile, int fd) {
+    for (size_t i = 0; i < iniFile->sectionCount; i++) {
+        const Section* section = &iniFile->sections[i];
+        if (!section->isModified || section->sourceOffset == ZINI_NO_SOURCE) continue;
+
+        char* buffer = (char*)malloc(section->sourceLength);
+        if (!buffer) {
+            perror("Failed to allocate memory for INI output");
+            return false;
+        }
+        zini_render_section(section, buffer);
+        bool ok = zini_pwrite_all(fd, buffer, section->sourceLength, section->sourceOffset);
+        free(buffer);
+        if (!ok) return false;
+    }
+    return true;
+}
+
+/*
+ * Rewrites the file from the first changed byte onwards. Untouched spans behind that point are read
+ * back from the file, changed ones are rendered, and new sections are appended. The section layout is
+ * updated as the tail is assembled.
+ */
+static bool zini_splice_tail(INIFILE* iniFile, int fd, size_t firstChange) {
+    // one byte in front of the change tells whether appended sections need a newline to start on
+    size_t readStart = firstChange ? firstChange - 1 : 0;
+    size_t originalLength = iniFile->sourceSize - readStart;
+    char* original = (char*)malloc(originalLength ? originalLength : 1);
+    if (!original) {
+        perror("Failed to allocate memory for INI file contents");
+        return false;
+    }
+    if (!zini_pread_all(fd, original, originalLength, readStart)) {
+        free(original);
+        return false;
+    }
+
+    size_t tailLength = 1; // room for a separating newline
+    for (size_t i = 0; i < iniFile->sectionCount; i++) {
+        const Section* section = &iniFile->sections[i];
+        bool inTail = section->sourceOffset == ZINI_NO_SOURCE || section->sourceOffset >= firstChange;
+        if (!inTail) continue;
+        if (section->sourceOffset != ZINI_NO_SOURCE && !section->isModified) tailLength += section->sourceLength;
+        else tailLength += zini_rendered_section_length(section);
+    }
+
+    char* tail = (char*)malloc(tailLength);
+    if (!tail) {
+        perror("Failed to allocate memory for INI output");
+        free(original);
+        return false;
+    }
+
+    char* out = tail;
+    char last = firstChange ? original[0] : '\n';
+    Section* lastSpan = NULL;
+    for (size_t i = 0; i < iniFile->sectionCount; i++) {
+        Section* section = &iniFile->sections[i];
+        bool fromSource = section->sourceOffset != ZINI_NO_SOURCE;
+        if (fromSource && section->sourceOffset < firstChange) {
+            lastSpan = section;
+            continue;
+        }
+
+        if (!fromSource && last != '\n') {
+            // the old last line had no newline, give it one before appending behind it
+            *out++ = '\n';
+            if (lastSpan) lastSpan->sourceLength++;
+        }
+
+        size_t offset = firstChange + (size_t)(out - tail);
+        if (fromSource && !section->isModified) {
+            memcpy(out, original + (section->sourceOffset - readStart), section->sourceLength);
+            out += section->sourceLength;
+        }
+        else {
+            out = zini_render_section(section, out);
+            section->sourceLength = (size_t)(out - tail) - (offset - firstChange);
+        }
+        section->sourceOffset = offset;
+        last = out[-1];
+        lastSpan = section;
+    }
+
+    size_t written = (size_t)(out - tail);
+    bool ok = zini_pwrite_all(fd, tail, written, firstChange) && ftruncate(fd, (off_t)(firstChange + written)) == 0;
+    free(tail);
+    free(original);
+
+    iniFile->sourceSize = ok ? firstChange + written : ZINI_NO_SOURCE;
+    return ok;
+}
+#endif // ZINI_HAVE_MMAP
+
+bool ZINI_SaveIncremental(INIFILE* iniFile, const char* filename) {
+    if (!iniFile || !filename) {
+        fprintf(stderr, "INI file or file name is NULL!\n");
+        return false;
+    }
+
+#ifdef ZINI_HAVE_MMAP
+    if (iniFile->sourceSize == ZINI_NO_SOURCE) return ZINI_Save(iniFile, filename);
+
+    int fd = open(filename, O_RDWR);
+    if (fd < 0) return ZINI_Save(iniFile, filename);
+
+    // another file, or one rewritten behind our back, no longer matches the recorded layout
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size != iniFile->sourceSize ||
+        !zini_same_version(zini_file_stamp(&info), iniFile->sourceFile)) {
+        close(fd);
+        return ZINI_Save(iniFile, filename);
+    }
+    if (!zini_detach_mapping_for(iniFile, &info)) {
+        close(fd);
+        return false;
+    }
+
+    // the span of a removed section has to go, so the file is rewritten from there on
+    size_t firstChange = iniFile->sourceSize;
+    bool sameSize = true;
+    if (iniFile->removedSource != ZINI_NO_SOURCE) {
+        firstChange = iniFile->removedSource;
+        sameSize = false;
+    }
+    for (size_t i = 0; i < iniFile->sectionCount; i++) {
+        const Section* section = &iniFile->sections[i];
+        if (section->sourceOffset == ZINI_NO_SOURCE) {
+            sameSize = false;
+            continue;
+        }
+        if (!section->isModified) continue;
+
+        if (section->sourceOffset < firstChange) firstChange = section->sourceOffset;
+        if (zini_rendered_section_length(section) != section->sourceLength) sameSize = false;
+    }
+
+    bool ok = true;
+    if (sameSize) ok = zini_splice_in_place(iniFile, fd);
+    else ok = zini_splice_tail(iniFile, fd, firstChange);
+    if (ok && fsync(fd) != 0) ok = false;
+    if (ok && fstat(fd, &info) != 0) ok = false;
+    if (close(fd) != 0) ok = false;
+
+    if (!ok) {
+        perror("Error writing INI file");
+        iniFile->sourceSize = ZINI_NO_SOURCE;
+        return false;
+    }
+
+    iniFile->sourceFile = zini_file_stamp(&info);
+    zini_mark_clean(iniFile);
+    return true;
+#else
+    return ZINI_Save(iniFile, filename);
+#endif // ZINI_HAVE_MMAP
+}
+
+/*
+ * Snapshot image written by ZINI_Compile. All tables are addressed by byte offsets from the start of the
+ * image, so it can be mapped anywhere, and every table starts on an 8-byte boundary. Strings are
+ * NUL-terminated so lookups can hand them out directly.
+ *
+ *   header | sections | pairs | pilots | slots | strings
+ */
+#define ZINI_SNAPSHOT_MAGIC "ZINS"
+#define ZINI_SNAPSHOT_VERSION 1
+#define ZINI_SNAPSHOT_BYTE_ORDER 0x01020304u
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t byteOrder;         // ZINI_SNAPSHOT_BYTE_ORDER as written, images are only read on the same byte order
+    uint32_t sectionCount;
+    uint32_t pairCount;
+    uint32_t bucketCount;
+    uint32_t slotCount;
+    uint32_t reserved;
+    uint64_t seed;
+    uint64_t sectionsOffset;
+    uint64_t pairsOffset;
+    uint64_t pilotsOffset;
+    uint64_t slotsOffset;
+    uint64_t stringsOffset;
+    uint64_t length;            // size of the whole image
+} ZINI_SnapshotHeader;
+
+typedef struct {
+    uint64_t name;              // offset into the string table
+    uint32_t nameLength;
+    uint32_t firstPair;
+    uint32_t pairCount;
+    uint32_t reserved;
+} ZINI_SnapshotSection;
+
+typedef struct {
+    uint64_t key;               // offsets into the string table
+    uint64_t value;
+    uint32_t keyLength;
+    uint32_t valueLength;
+    uint32_t section;
+    uint32_t reserved;
+} ZINI_SnapshotPair;
+
+static uint64_t zini_align8(uint64_t offset) {
+    return (offset + 7) & ~(uint64_t)7;
+}
+
+// renders the snapshot image of an INIFILE into one malloc'd buffer
+static char* zini_build_snapshot(const INIFILE* iniFile, size_t* length) {
+    // every section and pair goes in, empty names and values included, so the snapshot answers as the file does
+    size_t sectionCount = iniFile->sectionCount;
+    size_t pairCount = 0;
+    uint64_t stringBytes = 0;
+    for (size_t i = 0; i < iniFile->sectionCount; i++) {
+        const Section* section = &iniFile->sections[i];
+        pairCount += section->pairCount;
+        stringBytes += section->sectionLength + 1;
+        for (size_t j = 0; j < section->pairCount; j++) {
+            const Pair* pair = &section->pairs[j];
+            stringBytes += pair->keyLength + 1 + pair->valueLength + 1;
+        }
+    }
+    if (sectionCount > UINT32_MAX || pairCount > UINT32_MAX / 2) {
+        fprintf(stderr, "INI file is too large for a snapshot!\n");
+        return NULL;
+    }
+
+    ZINI_SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ZINI_SNAPSHOT_MAGIC, 4);
+    header.version = ZINI_SNAPSHOT_VERSION;
+    header.byteOrder = ZINI_SNAPSHOT_BYTE_ORDER;
+    header.sectionCount = (uint32_t)sectionCount;
+    header.pairCount = (uint32_t)pairCount;
+
+    uint64_t* hashes = (uint64_t*)malloc((pairCount ? pairCount : 1) * sizeof(uint64_t));
+    if (!hashes) {
+        perror("Failed to allocate memory for snapshot");
+        return NULL;
+    }
+    size_t p = 0;
+    for (size_t i = 0; i < iniFile->sectionCount; i++) {
+        const Section* section = &iniFile->sections[i];
+        uint64_t sectionHash = zini_hash(section->section, section->sectionLength);
+        for (size_t j = 0; j < section->pairCount; j++) {
+            const Pair* pair = &section->pairs[j];
+            hashes[p++] = zini_pair_hash(sectionHash, pair->key, pair->keyLength);
+        }
+    }
+
+    ZINI_PerfectHash phf;
+    bool built = zini_phf_build(&phf, hashes, (uint32_t)pairCount);
+    free(hashes);
+    if (!built) return NULL;
+    header.bucketCount = phf.bucketCount;
+    header.slotCount = phf.slotCount;
+    header.seed = phf.seed;
+
+    header.sectionsOffset = zini_align8(sizeof(header));
+    header.pairsOffset = zini_align8(header.sectionsOffset + sectionCount * sizeof(ZINI_SnapshotSection));
+    header.pilotsOffset = zini_align8(header.pairsOffset + pairCount * sizeof(ZINI_SnapshotPair));
+    header.slotsOffset = zini_align8(header.pilotsOffset + (uint64_t)phf.bucketCount * sizeof(uint32_t));
+    header.stringsOffset = zini_align8(header.slotsOffset + (uint64_t)phf.slotCount * sizeof(uint32_t));
+    header.length = header.stringsOffset + stringBytes;
+    if (header.length > SIZE_MAX) {
+        fprintf(stderr, "INI file is too large for a snapshot!\n");
+        zini_phf_free(&phf);
+        return NULL;
+    }
+
+    char* image = (char*)calloc(1, (size_t)header.length);
+    if (!image) {
+        perror("Failed to allocate memory for snapshot");
+        zini_phf_free(&phf);
+        return NULL;
+    }
+    memcpy(image, &header, sizeof(header));
+    memcpy(image + header.pilotsOffset, phf.pilots, phf.bucketCount * sizeof(uint32_t));
+    memcpy(image + header.slotsOffset, phf.slots, phf.slotCount * sizeof(uint32_t));
+    zini_phf_free(&phf);
+
+    ZINI_SnapshotSection* sections = (ZINI_SnapshotSection*)(image + header.sectionsOffset);
+    ZINI_SnapshotPair* pairs = (ZINI_SnapshotPair*)(image + header.pairsOffset);
+    char* strings = image + header.stringsOffset;
+    uint64_t stringOffset = 0;
+    uint32_t s = 0;
+    p = 0;
+    for (size_t i = 0; i < iniFile->sectionCount; i++) {
+        const Section* section = &iniFile->sections[i];
+        sections[s].name = stringOffset;
+        sections[s].nameLength = (uint32_t)section->sectionLength;
+        sections[s].firstPair = (uint32_t)p;
+        memcpy(strings + stringOffset, section->section, section->sectionLength);
+        stringOffset += section->sectionLength + 1;
+
+        for (size_t j = 0; j < section->pairCount; j++) {
+            const Pair* pair = &section->pairs[j];
+            pairs[p].key = stringOffset;
+            pairs[p].keyLength = (uint32_t)pair->keyLength;
+            memcpy(strings + stringOffset, pair->key, pair->keyLength);
+            stringOffset += pair->keyLength + 1;
+            pairs[p].value = stringOffset;
+            pairs[p].valueLength = (uint32_t)pair->valueLength;
+            memcpy(strings + stringOffset, pair->value, pair->valueLength);
+            stringOffset += pair->valueLength + 1;
+            pairs[p].section = s;
+            p++;
+        }
+        sections[s].pairCount = (uint32_t)p - sections[s].firstPair;
+        s++;
+    }
+
+    *length = (size_t)header.length;
+    return image;
+}
+
+bool ZINI_Compile(INIFILE* iniFile, const char* filename) {
+    if (!iniFile || !filename) {
+        fprintf(stderr, "INI file or file name is NULL!\n");
+        return false;
+    }
+
+    size_t length;
+    char* image = zini_build_snapshot(iniFile, &length);
+    if (!image) return false;
+
+#ifdef ZINI_HAVE_MMAP
+    // replaced by rename, so processes that still map the old snapshot keep reading it unharmed
+    char* tempPath = zini_temp_path(filename);
+    bool ok = tempPath && zini_write_temp_data(image, length, filename, tempPath);
+    if (ok && rename(tempPath, filename) != 0) {
+        perror("Error replacing snapshot file");
+        unlink(tempPath);
+        ok = false;
+    }
+    if (ok) {
+        char* directory = zini_directory_of(filename);
+        ok = zini_sync_directory(directory);
+        if (!ok) perror("Error syncing snapshot directory");
+        free(directory);
+    }
+    free(tempPath);
+#else
+    FILE* file = fopen(filename, "wb");
+    bool ok = file && fwrite(image, 1, length, file) == length;
+    if (file && fclose(file) != 0) ok = false;
+    if (!ok) perror("Error writing snapshot file");
+#endif // ZINI_HAVE_MMAP
+
+    free(image);
+    return ok;
+}
+
+// a table of count records of the given size must lie within the image
+static bool zini_snapshot_table_fits(const ZINI_SnapshotHeader* header, uint64_t offset, uint64_t count, uint64_t size) {
+    return offset % 8 == 0 && offset <= header->length && count <= (header->length - offset) / size;
+}
+
+// checks the header and table bounds, records and strings are checked when a lookup reaches them
+static bool zini_snapshot_valid(const char* image, size_t length) {
+    if (length < sizeof(ZINI_SnapshotHeader)) return false;
+
+    const ZINI_SnapshotHeader* header = (const ZINI_SnapshotHeader*)image;
+    if (memcmp(header->magic, ZINI_SNAPSHOT_MAGIC, 4) != 0) return false;
+    if (header->version != ZINI_SNAPSHOT_VERSION || header->byteOrder != ZINI_SNAPSHOT_BYTE_ORDER) return false;
+    if (header->length != length) return false;
+    if (header->pairCount > UINT32_MAX / 2) return false;
+    if (header->bucketCount != zini_phf_bucket_count(header->pairCount) ||
+        header->slotCount != zini_phf_slot_count(header->pairCount)) return false;
+
+    return zini_snapshot_table_fits(header, header->sectionsOffset, header->sectionCount, sizeof(ZINI_SnapshotSection)) &&
+           zini_snapshot_table_fits(header, header->pairsOffset, header->pairCount, sizeof(ZINI_SnapshotPair)) &&
+           zini_snapshot_table_fits(header, header->pilotsOffset, header->bucketCount, sizeof(uint32_t)) &&
+           zini_snapshot_table_fits(header, header->slotsOffset, header->slotCount, sizeof(uint32_t)) &&
+           header->stringsOffset <= header->length;
+}
+
+bool ZINI_OpenSnapshot(ZINI_Snapshot* snapshot, const char* filename) {
+    if (!snapshot || !filename) {
+        fprintf(stderr, "Snapshot or file name is NULL!\n");
+        return false;
+    }
+    snapshot->image = NULL;
+    snapshot->imageLength = 0;
+    snapshot->mapped = false;
+
+#ifdef ZINI_HAVE_MMAP
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        perror("Error opening snapshot file");
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        fprintf(stderr, "Invalid snapshot file!\n");
+        close(fd);
+        return false;
+    }
+
+    size_t length = (size_t)info.st_size;
+    void* image = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (image == MAP_FAILED) {
+        perror("Error mapping snapshot file");
+        return false;
+    }
+    snapshot->mapped = true;
+#else
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+        perror("Error opening snapshot file");
+        return false;
+    }
+
+    long end = -1;
+    if (fseek(file, 0, SEEK_END) == 0) end = ftell(file);
+    char* image = end > 0 ? (char*)malloc((size_t)end) : NULL;
+    size_t length = end > 0 ? (size_t)end : 0;
+    bool ok = image && fseek(file, 0, SEEK_SET) == 0 && fread(image, 1, length, file) == length;
+    fclose(file);
+    if (!ok) {
+        perror("Error reading snapshot file");
+        free(image);
+        return false;
+    }
+#endif // ZINI_HAVE_MMAP
+
+    snapshot->image = (const char*)image;
+    snapshot->imageLength = length;
+    if (!zini_snapshot_valid(snapshot->image, length)) {
+        fprintf(stderr, "Invalid snapshot file!\n");
+        ZINI_CloseSnapshot(snapshot);
+        return false;
+    }
+    return true;
+}
+
+// the string at offset must have length bytes and its terminator inside the string table
+static const char* zini_snapshot_string(const ZINI_Snapshot* snapshot, uint64_t offset, uint32_t length) {
+    const ZINI_SnapshotHeader* header = (const ZINI_SnapshotHeader*)snapshot->image;
+    uint64_t size = header->length - header->stringsOffset;
+    if (offset >= size || length >= size - offset) return NULL;
+
+    const char* str = snapshot->image + header->stringsOffset + offset;
+    return str[length] == '\0' ? str : NULL;
+}
+
+const char* ZINI_SnapshotGetValue(const ZINI_Snapshot* snapshot, const char* section, const char* key) {
+    if (!snapshot || !snapshot->image || !section || !key) {
+        fprintf(stderr, "Snapshot or section or key is NULL!\n");
+        return NULL;
+    }
+
+    const ZINI_SnapshotHeader* header = (const ZINI_SnapshotHeader*)snapshot->image;
+    if (!header->pairCount) return NULL;
+
+    size_t sectionLength = strlen(section);
+    size_t keyLength = strlen(key);
+    uint64_t hash = zini_pair_hash(zini_hash(section, sectionLength), key, keyLength);
+
+    const uint32_t* pilots = (const uint32_t*)(snapshot->image + header->pilotsOffset);
+    const uint32_t* slots = (const uint32_t*)(snapshot->image + header->slotsOffset);
+    uint32_t index = slots[zini_phf_slot(header->seed, pilots, header->bucketCount, header->slotCount, hash)];
+    if (index >= header->pairCount) return NULL;
+
+    // the slot holds whichever pair hashes there, so a missing key still has to be told apart
+    const ZINI_SnapshotPair* pair = (const ZINI_SnapshotPair*)(snapshot->image + header->pairsOffset) + index;
+    if (pair->keyLength != keyLength || pair->section >= header->sectionCount) return NULL;
+    const ZINI_SnapshotSection* sec = (const ZINI_SnapshotSection*)(snapshot->image + header->sectionsOffset) + pair->section;
+    if (sec->nameLength != sectionLength) return NULL;
+
+    const char* storedKey = zini_snapshot_string(snapshot, pair->key, pair->keyLength);
+    const char* storedSection = zini_snapshot_string(snapshot, sec->name, sec->nameLength);
+    if (!storedKey || !storedSection || memcmp(storedKey, key, keyLength) != 0 ||
+        memcmp(storedSection, section, sectionLength) != 0) return NULL;
+
+    return zini_snapshot_string(snapshot, pair->value, pair->valueLength);
+}
+
+void ZINI_CloseSnapshot(ZINI_Snapshot* snapshot) {
+    if (!snapshot || !snapshot->image) return;
+#ifdef ZINI_HAVE_MMAP
+    if (snapshot->mapped) munmap((void*)snapshot->image, snapshot->imageLength);
+    else free((void*)snapshot->image);
+#else
+    free((void*)snapshot->image);
+#endif // ZINI_HAVE_MMAP
+    snapshot->image = NULL;
+    snapshot->imageLength = 0;
+    snapshot->mapped = false;
+}
+
+/*
+ * Index of a frozen INIFILE: a perfect hash over all (section, key) pairs, with each slot holding the
+ * pair itself, so a lookup is one hash, one probe and one compare. Nothing can move while the file is
+ * frozen, so the pointers stay valid.
+ */
+typedef struct {
+    uint64_t hash;              // pair hash of the entry, empty slots have no pair
+    const Section* section;
+    Pair* pair;
+} ZINI_FrozenSlot;
+
+struct INIFrozenIndex {
+    uint64_t seed;
+    uint32_t bucketCount;
+    uint32_t slotCount;
+    uint32_t* pilots;
+    ZINI_FrozenSlot* slots;
+};
+
+static void zini_frozen_free(INIFILE* iniFile) {
+    if (!iniFile->frozen) return;
+    free(iniFile->frozen->pilots);
+    free(iniFile->frozen->slots);
+    free(iniFile->frozen);
+    iniFile->frozen = NULL;
+}
+
+static Pair* zini_frozen_find_hashed(const INIFILE* iniFile, uint64_t hash, const char* section, size_t sectionLength, const char* key, size_t keyLength) {
+    const ZINI_FrozenIndex* frozen = iniFile->frozen;
+    const ZINI_FrozenSlot* slot = &frozen->slots[zini_phf_slot(frozen->seed, frozen->pilots, frozen->bucketCount, frozen->slotCount, hash)];
+
+    if (!slot->pair || slot->hash != hash) return NULL;
+    if (slot->pair->keyLength != keyLength || slot->section->sectionLength != sectionLength) return NULL;
+    if (memcmp(slot->pair->key, key, keyLength) != 0 || memcmp(slot->section->section, section, sectionLength) != 0) return NULL;
+    return slot->pair;
+}
+
+static Pair* zini_frozen_find(const INIFILE* iniFile, const char* section, size_t sectionLength, const char* key, size_t keyLength) {
+    uint64_t hash = zini_pair_hash(zini_hash(section, sectionLength), key, keyLength);
+    return zini_frozen_find_hashed(iniFile, hash, section, sectionLength, key, keyLength);
+}
+
+// mutators bail out through this, so a frozen file never moves or changes
+static bool zini_rejects_changes(const INIFILE* iniFile) {
+    if (!iniFile->frozen) return false;
+    fprintf(stderr, "INI file is frozen!\n");
+    return true;
+}
+
+bool ZINI_Freeze(INIFILE* iniFile) {
+    if (!iniFile) {
+        fprintf(stderr, "INI file is NULL!\n");
+        return false;
+    }
+    if (iniFile->frozen) return true;
+
+    // every pair the unfrozen lookups can find, empty values included, or freezing would change answers
+    size_t count = 0;
+    for (size_t i = 0; i < iniFile->sectionCount; i++) count += iniFile->sections[i].pairCount;
+    if (count > UINT32_MAX / 2) {
+        fprintf(stderr, "INI file is too large to freeze!\n");
+        return false;
+    }
+
+    uint64_t* hashes = (uint64_t*)malloc((count ? count : 1) * sizeof(uint64_t));
+    ZINI_FrozenSlot* entries = (ZINI_FrozenSlot*)malloc((count ? count : 1) * sizeof(ZINI_FrozenSlot));
+    ZINI_FrozenIndex* frozen = (ZINI_FrozenIndex*)calloc(1, sizeof(ZINI_FrozenIndex));
+    if (!hashes || !entries || !frozen) {
+        perror("Failed to allocate memory for frozen index");
+        free(hashes);
+        free(entries);
+        free(frozen);
+        return false;
+    }
+
+    size_t n = 0;
+    for (size_t i = 0; i < iniFile->sectionCount; i++) {
+        Section* section = &iniFile->sections[i];
+        uint64_t sectionHash = zini_hash(section->section, section->sectionLength);
+        for (size_t j = 0; j < section->pairCount; j++) {
+            Pair* pair = &section->pairs[j];
+            hashes[n] = zini_pair_hash(sectionHash, pair->key, pair->keyLength);
+            entries[n].hash = hashes[n];
+            entries[n].section = section;
+            entries[n].pair = pair;
+            n++;
+        }
+    }
+
+    ZINI_PerfectHash phf;
+    bool ok = zini_phf_build(&phf, hashes, (uint32_t)count);
+    free(hashes);
+    if (ok) {
+        frozen->slots = (ZINI_FrozenSlot*)calloc(phf.slotCount, sizeof(ZINI_FrozenSlot));
+        ok = frozen->slots != NULL;
+        if (!ok) perror("Failed to allocate memory for frozen index");
+    }
+    if (!ok) {
+        if (phf.pilots) zini_phf_free(&phf);
+        free(entries);
+        free(frozen);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < phf.slotCount; i++) {
+        if (phf.slots[i] != UINT32_MAX) frozen->slots[i] = entries[phf.slots[i]];
+    }
+    free(entries);
+
+    // the pilots move over, the slot-to-entry table is not needed once the entries sit in their slots
+    frozen->seed = phf.seed;
+    frozen->bucketCount = phf.bucketCount;
+    frozen->slotCount = phf.slotCount;
+    frozen->pilots = phf.pilots;
+    free(phf.slots);
+
+    // lookups go through the frozen table from now on
+    zini_path_free(&iniFile->pathIndex);
+    iniFile->frozen = frozen;
+    return true;
+}
+
+bool ZINI_Reserve(INIFILE* iniFile, size_t sections, size_t pairsPerSection) {
+    if (!iniFile) {
+        fprintf(stderr, "INI file is NULL!\n");
+        return false;
+    }
+    if (zini_rejects_changes(iniFile)) return false;
+
+    if (!zini_reserve_sections(iniFile, sections)) return false;
+    if (!zini_index_reserve(&iniFile->sectionIndex, sections)) return false;
+
+    for (size_t i = 0; i < iniFile->sectionCount; i++) {
+        Section* section = &iniFile->sections[i];
+        if (!zini_reserve_pairs(section, pairsPerSection)) return false;
+        if (pairsPerSection > ZINI_PAIR_INDEX_THRESHOLD && section->pairIndex.capacity &&
+            !zini_index_reserve(&section->pairIndex, pairsPerSection)) return false;
+    }
+
+    iniFile->pairReserve = pairsPerSection;
+    return true;
+}
+
+static const char* zini_compact_string(char** out, const char* str, size_t length) {
+    char* copy = *out;
+    memcpy(copy, str, length);
+    copy[length] = '\0';
+    *out += length + 1;
+    return copy;
+}
+
+// failing to shrink only keeps the larger array, so errors are ignored
+static void zini_shrink_pairs(Section* section) {
+    if (section->pairCapacity == section->pairCount) return;
+    if (!section->pairCount) {
+        free(section->pairs);
+        section->pairs = NULL;
+        section->pairCapacity = 0;
+        return;
+    }
+
+    Pair* newptr = (Pair*)realloc(section->pairs, section->pairCount * sizeof(Pair));
+    if (!newptr) return;
+    section->pairs = newptr;
+    section->pairCapacity = section->pairCount;
+}
+
+static void zini_shrink_sections(INIFILE* iniFile) {
+    if (iniFile->sectionCapacity == iniFile->sectionCount) return;
+    if (!iniFile->sectionCount) {
+        free(iniFile->sections);
+        iniFile->sections = NULL;
+        iniFile->sectionCapacity = 0;
+        return;
+    }
+
+    Section* newptr = (Section*)realloc(iniFile->sections, iniFile->sectionCount * sizeof(Section));
+    if (!newptr) return;
+    iniFile->sections = newptr;
+    iniFile->sectionCapacity = iniFile->sectionCount;
+}
+
+bool ZINI_Compact(INIFILE* iniFile) {
+    if (!iniFile) {
+        fprintf(stderr, "INI file is NULL!\n");
+        return false;
+    }
+    if (zini_rejects_changes(iniFile)) return false;
+
+    size_t total = 0;
+    for (size_t i = 0; i < iniFile->sectionCount; i++) {
+        const Section* section = &iniFile->sections[i];
+        total += section->sectionLength + 1;
+        for (size_t j = 0; j < section->pairCount; j++) total += section->pairs[j].keyLength + section->pairs[j].valueLength + 2;
+    }
+
+    // the new arena is filled before the old one goes, so a failed allocation changes nothing
+    ZINI_ArenaBlock* block = NULL;
+    if (total) {
+        block = (ZINI_ArenaBlock*)malloc(sizeof(ZINI_ArenaBlock) + total);
+        if (!block) {
+            perror("Failed to allocate memory for strings");
+            return false;
+        }
+        block->next = NULL;
+        block->used = total;
+        block->capacity = total;
+    }
+
+    char* out = block ? block->data : NULL;
+    for (size_t i = 0; i < iniFile->sectionCount; i++) {
+        Section* section = &iniFile->sections[i];
+        section->section = zini_compact_string(&out, section->section, section->sectionLength);
+        for (size_t j = 0; j < section->pairCount; j++) {
+            Pair* pair = &section->pairs[j];
+            pair->key = zini_compact_string(&out, pair->key, pair->keyLength);
+            pair->value = zini_compact_string(&out, pair->value, pair->valueLength);
+        }
+
+        zini_shrink_pairs(section);
+        if (section->pairCount <= ZINI_PAIR_INDEX_THRESHOLD) zini_index_free(&section->pairIndex);
+        else zini_index_fit(&section->pairIndex);
+    }
+
+    zini_arena_free(iniFile);
+    iniFile->arena = block;
+#ifdef ZINI_HAVE_MMAP
+    if (iniFile->mapping) munmap(iniFile->mapping, iniFile->mappingLength);
+#endif // ZINI_HAVE_MMAP
+    iniFile->mapping = NULL;
+    iniFile->mappingLength = 0;
+
+    zini_shrink_sections(iniFile);
+    zini_index_fit(&iniFile->sectionIndex);
+    // the path index is rebuilt at its fitting size by the next lookup
+    zini_path_free(&iniFile->pathIndex);
+    iniFile->generation++;
+    return true;
+}
+
+Section* ZINI_AddSection(INIFILE* iniFile, const char* section) {
+    if (!iniFile || !section) {
+        fprintf(stderr, "INIFIle or Sections is NULL!\n");
+        return NULL;
+    }
+    if (zini_rejects_changes(iniFile)) return NULL;
+
+    if (ZINI_SectionExists(iniFile, section)) {
+        fprintf(stderr, "Sections Exist!\n");
+        return NULL;
+    }
+
+    return zini_add_section_n(iniFile, section, strlen(section), false);
+}
+
+Pair* ZINI_AddPair(Section* section, const char* key, const char* value) {
+    if (!section || !key || !value) {
+        fprintf(stderr, "Section or Key or Value is NULL!\n");
+        return NULL;
+    }
+    if (zini_rejects_changes(section->owner)) return NULL;
+
+    if (ZINI_KeyExists(section, key)) {
+        fprintf(stderr, "Key Exist!\n");
+        return NULL;
+    }
+
+    return zini_add_pair_n(section, key, strlen(key), value, strlen(value), false);
+}
+
+Pair* ZINI_AddPairEx(INIFILE* iniFile, const char* section, const char* key, const char* value) {
+    if (!iniFile || !section || !key || !value) {
+        fprintf(stderr, "INI File or Section or Key or Value is NULL!\n");
+        return NULL;
+    }
+
+    Section* sec = ZINI_FindSection(iniFile, section);
+    if (!sec) return NULL;
+    Pair* newPair = ZINI_AddPair(sec, key, value);
+    return newPair;
+}
+
+// two ASCII digits for every value below 100, integers are written a pair of digits at a time
+static const char zini_digit_pairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// writes the decimal digits of value to out, returns the end of the text, which is not NUL-terminated
+static char* zini_format_uint64(uint64_t value, char* out) {
+    char digits[20];
+    char* p = digits + sizeof(digits);
+    while (value >= 100) {
+        unsigned pair = (unsigned)(value % 100) * 2;
+        value /= 100;
+        *--p = zini_digit_pairs[pair + 1];
+        *--p = zini_digit_pairs[pair];
+    }
+    if (value >= 10) {
+        *--p = zini_digit_pairs[value * 2 + 1];
+        *--p = zini_digit_pairs[value * 2];
+    }
+    else {
+        *--p = (char)('0' + value);
+    }
+
+    size_t length = (size_t)(digits + sizeof(digits) - p);
+    memcpy(out, p, length);
+    return out + length;
+}
+
+static char* zini_format_int64(int64_t value, char* out) {
+    if (value < 0) {
+        *out++ = '-';
+        return zini_format_uint64(0 - (uint64_t)value, out);
+    }
+    return zini_format_uint64((uint64_t)value, out);
+}
+
+/*
+ * Shortest round-trip formatting with Grisu2 (Loitsch, "Printing Floating-Point Numbers Quickly and
+ * Accurately with Integers"). The value and both boundaries of its rounding interval are scaled by a
+ * cached power of ten into 64-bit fixed point, and digits are generated until the text falls inside the
+ * interval. The result always reads back as the same value and is the shortest such text in all but
+ * very rare cases, where it is one digit longer.
+ */
+typedef struct {
+    uint64_t f;
+    int e;
+} ZINI_DiyFp;
+
+// normalized 10^k for k = -348, -340, ..., 340
+static const ZINI_DiyFp zini_cached_powers[] = {
+    { 0xfa8fd5a0081c0288ULL, -1220 }, { 0xbaaee17fa23ebf76ULL, -1193 },
+    { 0x8b16fb203055ac76ULL, -1166 }, { 0xcf42894a5dce35eaULL, -1140 },
+    { 0x9a6bb0aa55653b2dULL, -1113 }, { 0xe61acf033d1a45dfULL, -1087 },
+    { 0xab70fe17c79ac6caULL, -1060 }, { 0xff77b1fcbebcdc4fULL, -1034 },
+    { 0xbe5691ef416bd60cULL, -1007 }, { 0x8dd01fad907ffc3cULL, -980 },
+    { 0xd3515c2831559a83ULL, -954 }, { 0x9d71ac8fada6c9b5ULL, -927 },
+    { 0xea9c227723ee8bcbULL, -901 }, { 0xaecc49914078536dULL, -874 },
+    { 0x823c12795db6ce57ULL, -847 }, { 0xc21094364dfb5637ULL, -821 },
+    { 0x9096ea6f3848984fULL, -794 }, { 0xd77485cb25823ac7ULL, -768 },
+    { 0xa086cfcd97bf97f4ULL, -741 }, { 0xef340a98172aace5ULL, -715 },
+    { 0xb23867fb2a35b28eULL, -688 }, { 0x84c8d4dfd2c63f3bULL, -661 },
+    { 0xc5dd44271ad3cdbaULL, -635 }, { 0x936b9fcebb25c996ULL, -608 },
+    { 0xdbac6c247d62a584ULL, -582 }, { 0xa3ab66580d5fdaf6ULL, -555 },
+    { 0xf3e2f893dec3f126ULL, -529 }, { 0xb5b5ada8aaff80b8ULL, -502 },
+    { 0x87625f056c7c4a8bULL, -475 }, { 0xc9bcff6034c13053ULL, -449 },
+    { 0x964e858c91ba2655ULL, -422 }, { 0xdff9772470297ebdULL, -396 },
+    { 0xa6dfbd9fb8e5b88fULL, -369 }, { 0xf8a95fcf88747d94ULL, -343 },
+    { 0xb94470938fa89bcfULL, -316 }, { 0x8a08f0f8bf0f156bULL, -289 },
+    { 0xcdb02555653131b6ULL, -263 }, { 0x993fe2c6d07b7facULL, -236 },
+    { 0xe45c10c42a2b3b06ULL, -210 }, { 0xaa242499697392d3ULL, -183 },
+    { 0xfd87b5f28300ca0eULL, -157 }, { 0xbce5086492111aebULL, -130 },
+    { 0x8cbccc096f5088ccULL, -103 }, { 0xd1b71758e219652cULL, -77 },
+    { 0x9c40000000000000ULL, -50 }, { 0xe8d4a51000000000ULL, -24 },
+    { 0xad78ebc5ac620000ULL, 3 }, { 0x813f3978f8940984ULL, 30 },
+    { 0xc097ce7bc90715b3ULL, 56 }, { 0x8f7e32ce7bea5c70ULL, 83 },
+    { 0xd5d238a4abe98068ULL, 109 }, { 0x9f4f2726179a2245ULL, 136 },
+    { 0xed63a231d4c4fb27ULL, 162 }, { 0xb0de65388cc8ada8ULL, 189 },
+    { 0x83c7088e1aab65dbULL, 216 }, { 0xc45d1df942711d9aULL, 242 },
+    { 0x924d692ca61be758ULL, 269 }, { 0xda01ee641a708deaULL, 295 },
+    { 0xa26da3999aef774aULL, 322 }, { 0xf209787bb47d6b85ULL, 348 },
+    { 0xb454e4a179dd1877ULL, 375 }, { 0x865b86925b9bc5c2ULL, 402 },
+    { 0xc83553c5c8965d3dULL, 428 }, { 0x952ab45cfa97a0b3ULL, 455 },
+    { 0xde469fbd99a05fe3ULL, 481 }, { 0xa59bc234db398c25ULL, 508 },
+    { 0xf6c69a72a3989f5cULL, 534 }, { 0xb7dcbf5354e9beceULL, 561 },
+    { 0x88fcf317f22241e2ULL, 588 }, { 0xcc20ce9bd35c78a5ULL, 614 },
+    { 0x98165af37b2153dfULL, 641 }, { 0xe2a0b5dc971f303aULL, 667 },
+    { 0xa8d9d1535ce3b396ULL, 694 }, { 0xfb9b7cd9a4a7443cULL, 720 },
+    { 0xbb764c4ca7a44410ULL, 747 }, { 0x8bab8eefb6409c1aULL, 774 },
+    { 0xd01fef10a657842cULL, 800 }, { 0x9b10a4e5e9913129ULL, 827 },
+    { 0xe7109bfba19c0c9dULL, 853 }, { 0xac2820d9623bf429ULL, 880 },
+    { 0x80444b5e7aa7cf85ULL, 907 }, { 0xbf21e44003acdd2dULL, 933 },
+    { 0x8e679c2f5e44ff8fULL, 960 }, { 0xd433179d9c8cb841ULL, 986 },
+    { 0x9e19db92b4e31ba9ULL, 1013 }, { 0xeb96bf6ebadf77d9ULL, 1039 },
+    { 0xaf87023b9bf0ee6bULL, 1066 }
+};
+
+static const uint64_t zini_pow10_u64[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL,
+    1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+    100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+    1000000000000000000ULL, 10000000000000000000ULL
+};
+
+// upper 64 bits of the 128-bit product, rounded
+static ZINI_DiyFp zini_diyfp_multiply(ZINI_DiyFp x, ZINI_DiyFp y) {
+    const uint64_t mask = 0xFFFFFFFFULL;
+    uint64_t a = x.f >> 32, b = x.f & mask, c = y.f >> 32, d = y.f & mask;
+    uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+    uint64_t middle = (bd >> 32) + (ad & mask) + (bc & mask) + (1ULL << 31);
+    ZINI_DiyFp product = { ac + (ad >> 32) + (bc >> 32) + (middle >> 32), x.e + y.e + 64 };
+    return product;
+}
+
+static ZINI_DiyFp zini_diyfp_normalize(ZINI_DiyFp x) {
+    while (!(x.f & (1ULL << 63))) {
+        x.f <<= 1;
+        x.e--;
+    }
+    return x;
+}
+
+// picks the cached power that brings the exponent of a value scaled by it into [-60, -32]
+static ZINI_DiyFp zini_cached_power(int e, int* k) {
+    double dk = (-61 - e) * 0.30102999566398114 + 347;
+    int ik = (int)dk;
+    if (dk - ik > 0.0) ik++;
+    unsigned index = (unsigned)((ik >> 3) + 1);
+    *k = -(-348 + (int)(index << 3));
+    return zini_cached_powers[index];
+}
+
+// nudges the last digit down while that moves the text closer to the exact value
+static void zini_grisu_round(char* buffer, int length, uint64_t delta, uint64_t rest, uint64_t tenKappa, uint64_t distance) {
+    while (rest < distance && delta - rest >= tenKappa &&
+           (rest + tenKappa < distance || distance - rest > rest + tenKappa - distance)) {
+        buffer[length - 1]--;
+        rest += tenKappa;
+    }
+}
+
+static int zini_grisu_digits(ZINI_DiyFp w, ZINI_DiyFp upper, uint64_t delta, char* buffer, int* k) {
+    ZINI_DiyFp one = { 1ULL << -upper.e, upper.e };
+    uint64_t distance = upper.f - w.f;
+    uint32_t integral = (uint32_t)(upper.f >> -one.e);
+    uint64_t fraction = upper.f & (one.f - 1);
+
+    int kappa = 1;
+    while (kappa < 10 && integral >= zini_pow10_u64[kappa]) kappa++;
+
+    int length = 0;
+    while (kappa > 0) {
+        uint32_t divisor = (uint32_t)zini_pow10_u64[kappa - 1];
+        uint32_t digit = integral / divisor;
+        integral %= divisor;
+        if (digit || length) buffer[length++] = (char)('0' + digit);
+        kappa--;
+        uint64_t rest = ((uint64_t)integral << -one.e) + fraction;
+        if (rest <= delta) {
+            *k += kappa;
+            zini_grisu_round(buffer, length, delta, rest, zini_pow10_u64[kappa] << -one.e, distance);
+            return length;
+        }
+    }
+
+    for (;;) {
+        fraction *= 10;
+        delta *= 10;
+        char digit = (char)(fraction >> -one.e);
+        if (digit || length) buffer[length++] = (char)('0' + digit);
+        fraction &= one.f - 1;
+        kappa--;
+        if (fraction < delta) {
+            *k += kappa;
+            int index = -kappa;
+            zini_grisu_round(buffer, length, delta, fraction, one.f, index < 20 ? distance * zini_pow10_u64[index] : 0);
+            return length;
+        }
+    }
+}
+
+/*
+ * Generates the digits of significand * 2^exponent into buffer, returns their count and sets *k so that
+ * the value is digits * 10^k. lowerCloser is set when the significand is a power of two, where the gap
+ * to the next smaller value is half the gap to the next larger one.
+ */
+static int zini_grisu2(uint64_t significand, int exponent, bool lowerCloser, char* buffer, int* k) {
+    ZINI_DiyFp v = { significand, exponent };
+    ZINI_DiyFp upper = zini_diyfp_normalize((ZINI_DiyFp){ (significand << 1) + 1, exponent - 1 });
+    ZINI_DiyFp lower = lowerCloser ? (ZINI_DiyFp){ (significand << 2) - 1, exponent - 2 }
+                                   : (ZINI_DiyFp){ (significand << 1) - 1, exponent - 1 };
+    lower.f <<= lower.e - upper.e;
+    lower.e = upper.e;
+
+    ZINI_DiyFp power = zini_cached_power(upper.e, k);
+    ZINI_DiyFp w = zini_diyfp_multiply(zini_diyfp_normalize(v), power);
+    ZINI_DiyFp scaledUpper = zini_diyfp_multiply(upper, power);
+    ZINI_DiyFp scaledLower = zini_diyfp_multiply(lower, power);
+    scaledLower.f++;
+    scaledUpper.f--;
+    return zini_grisu_digits(w, scaledUpper, scaledUpper.f - scaledLower.f, buffer, k);
+}
+
+/*
+ * Lays out length digits scaled by 10^k as plain decimal when that stays short, with an exponent
+ * otherwise. Integral values keep a ".0" so they still read as floating point.
+ */
+static char* zini_format_decimal(const char* digits, int length, int k, char* out) {
+    int point = length + k;
+
+    if (k >= 0 && point <= 21) {
+        memcpy(out, digits, (size_t)length);
+        out += length;
+        for (int i = 0; i < k; i++) *out++ = '0';
+        *out++ = '.';
+        *out++ = '0';
+    }
+    else if (point > 0 && point <= 21) {
+        memcpy(out, digits, (size_t)point);
+        out += point;
+        *out++ = '.';
+        memcpy(out, digits + point, (size_t)(length - point));
+        out += length - point;
+    }
+    else if (point > -6 && point <= 0) {
+        *out++ = '0';
+        *out++ = '.';
+        for (int i = point; i < 0; i++) *out++ = '0';
+        memcpy(out, digits, (size_t)length);
+        out += length;
+    }
+    else {
+        *out++ = digits[0];
+        if (length > 1) {
+            *out++ = '.';
+            memcpy(out, digits + 1, (size_t)(length - 1));
+            out += length - 1;
+        }
+        *out++ = 'e';
+        out = zini_format_int64(point - 1, out);
+    }
+    return out;
+}
+
+// writes the shortest text that reads back as value, NUL-terminated; out must hold 32 bytes
+static void zini_format_shortest(double value, bool single, char* out) {
+    if (value != value || value - value != 0) {
+        snprintf(out, 32, "%f", value);
+        return;
+    }
+
+    uint64_t significand;
+    int exponent;
+    bool lowerCloser;
+    if (single) {
+        float narrow = (float)value;
+        uint32_t bits;
+        memcpy(&bits, &narrow, sizeof(bits));
+        if (bits >> 31) *out++ = '-';
+        uint32_t fraction = bits & 0x7FFFFF;
+        int biased = (int)((bits >> 23) & 0xFF);
+        significand = biased ? fraction | 0x800000 : fraction;
+        exponent = biased ? biased - 150 : -149;
+        lowerCloser = fraction == 0 && biased > 1;
+    }
+    else {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        if (bits >> 63) *out++ = '-';
+        uint64_t fraction = bits & 0xFFFFFFFFFFFFFULL;
+        int biased = (int)((bits >> 52) & 0x7FF);
+        significand = biased ? fraction | 0x10000000000000ULL : fraction;
+        exponent = biased ? biased - 1075 : -1074;
+        lowerCloser = fraction == 0 && biased > 1;
+    }
+
+    if (significand == 0) {
+        memcpy(out, "0.0", 4);
+        return;
+    }
+
+    char digits[20];
+    int k;
+    int length = zini_grisu2(significand, exponent, lowerCloser, digits, &k);
+    *zini_format_decimal(digits, length, k, out) = '\0';
+}
+
+Pair* ZINI_AddPairVT(Section* section, const char* key, void* value, ZINI_DType type) {
+    if (!section || !key || !value) {
+        fprintf(stderr, "Sections or key or value is NULL!\n");
+        return NULL;
+    }
+
+    char buffer[ZINI_FORMAT_BUFFER];
+    bool shortest = section->owner->floatFormat == ZINI_FORMAT_SHORTEST;
+    switch (type) {
+        case ZINI_STR:
+            return ZINI_AddPair(section, key, (const char*)value);
+        case ZINI_INT:
+            *zini_format_int64(*(int*)value, buffer) = '\0';
+            break;
+        case ZINI_LINT:
+            *zini_format_int64(*(long int*)value, buffer) = '\0';
+            break;
+        case ZINI_LLINT:
+            *zini_format_int64(*(long long int*)value, buffer) = '\0';
+            break;
+        case ZINI_UINT:
+            *zini_format_uint64(*(unsigned int*)value, buffer) = '\0';
+            break;
+        case ZINI_FLOAT:
+            if (shortest) zini_format_shortest(*(float*)value, true, buffer);
+            else snprintf(buffer, sizeof(buffer), "%.*f", MAX_FLOAT_PRECISION, *(float*)value);
+            break;
+        case ZINI_DOUBLE:
+            if (shortest) zini_format_shortest(*(double*)value, false, buffer);
+            else snprintf(buffer, sizeof(buffer), "%.*f", MAX_DOUBLE_PRECISION, *(double*)value);
+            break;
+        case ZINI_BOOL:
+            strcpy(buffer, (*(bool*)value) ? "true" : "false");
+            break;
+        default:
+            fprintf(stderr, "Data Type Error!\n");
+            return NULL;
+    }
+
+    return ZINI_AddPair(section, key, buffer);
+}
+
+Pair* ZINI_AddPairVTEx(INIFILE* iniFile, const char* section, const char* key, void* value, ZINI_DType type) {
+    if (!section || !key || !value) {
+        fprintf(stderr, "INI File or Sections or Key or Value is NULL!\n");
+        return NULL;
+    }
+
+    Section* sec = ZINI_FindSection(iniFile, section);
+    if (!sec) return NULL;
+    Pair* newPair = ZINI_AddPairVT(sec, key, value, type);
+    return newPair;
+}
+
+Section* ZINI_FindSection(INIFILE* iniFile, const char* section) {
+    if (!iniFile || !section) {
+        fprintf(stderr, "INI file or section name is NULL!\n");
+        return NULL;
+    }
+
+    return zini_find_section_n(iniFile, section, strlen(section));
+}
+
+const char* ZINI_GetValue(Section* section, const char* key) {
+    if (!section || !key) {
+        fprintf(stderr, "Section or key is NULL!\n");
+        return NULL;
+    }
+
+    const Pair* pair = zini_find_pair(section, key);
+    if (pair) return pair->value;
+
+    fprintf(stderr, "Key doesn't exist!\n");
+    return NULL;
+}
+
+const char* ZINI_GetValueEx(INIFILE* iniFile, const char* section, const char* key) {
+    if (!iniFile || !key || !section) {
+        fprintf(stderr, "INI file or key or section is NULL!\n");
+        return NULL;
+    }
+
+    if (iniFile->frozen) {
+        const Pair* pair = zini_frozen_find(iniFile, section, strlen(section), key, strlen(key));
+        if (pair) return pair->value;
+
+        fprintf(stderr, "Key doesn't exist!\n");
+        return NULL;
+    }
+
+    const char* value = ZINI_GetValue(ZINI_FindSection(iniFile, section), key);
+    return value;
+}
+
+static Pair* zini_path_find(INIFILE* iniFile, uint64_t hash, const char* section, size_t sectionLength, const char* key, size_t keyLength) {
+    if (iniFile->frozen) return zini_frozen_find_hashed(iniFile, hash, section, sectionLength, key, keyLength);
+
+    const ZINI_PathIndex* index = &iniFile->pathIndex;
+    if (!index->capacity && !zini_build_path_index(iniFile)) {
+        Section* found = zini_find_section_n(iniFile, section, sectionLength);
+        return found ? zini_find_pair_n(found, key, keyLength) : NULL;
+    }
+
+    size_t mask = index->capacity - 1;
+    for (size_t i = hash & mask; index->slots[i].section; i = (i + 1) & mask) {
+        if (index->slots[i].hash != hash) continue;
+        Section* candidate = &iniFile->sections[index->slots[i].section - 1];
+        Pair* pair = &candidate->pairs[index->slots[i].pair];
+        if (pair->keyLength == keyLength && candidate->sectionLength == sectionLength &&
+            memcmp(pair->key, key, keyLength) == 0 && memcmp(candidate->section, section, sectionLength) == 0) return pair;
+    }
+    return NULL;
+}
+
+const char* ZINI_Get(INIFILE* iniFile, const char* path) {
+    if (!iniFile || !path) {
+        fprintf(stderr, "INI file or path is NULL!\n");
+        return NULL;
+    }
+
+    size_t length = strlen(path);
+    for (size_t dot = length; dot-- > 0;) {
+        if (path[dot] != '.') continue;
+        const char* key = path + dot + 1;
+        uint64_t hash = zini_pair_hash(zini_hash(path, dot), key, length - dot - 1);
+        const Pair* pair = zini_path_find(iniFile, hash, path, dot, key, length - dot - 1);
+        if (pair) return pair->value;
+    }
+    return NULL;
+}
+
+const char* ZINI_Get2(INIFILE* iniFile, const char* section, const char* key) {
+    if (!iniFile || !section || !key) {
+        fprintf(stderr, "INI file or key or section is NULL!\n");
+        return NULL;
+    }
+
+    size_t sectionLength = strlen(section);
+    size_t keyLength = strlen(key);
+    uint64_t hash = zini_pair_hash(zini_hash(section, sectionLength), key, keyLength);
+    const Pair* pair = zini_path_find(iniFile, hash, section, sectionLength, key, keyLength);
+    return pair ? pair->value : NULL;
+}
+
+uint64_t ZINI_KeyHash(const char* section, const char* key) {
+    if (!section || !key) {
+        fprintf(stderr, "Section or key is NULL!\n");
+        return 0;
+    }
+    return zini_pair_hash(zini_hash(section, strlen(section)), key, strlen(key));
+}
+
+const char* ZINI_GetHashed(INIFILE* iniFile, uint64_t hash, const char* section, const char* key) {
+    if (!iniFile || !section || !key) {
+        fprintf(stderr, "INI file or key or section is NULL!\n");
+        return NULL;
+    }
+
+    const Pair* pair = zini_path_find(iniFile, hash, section, strlen(section), key, strlen(key));
+    return pair ? pair->value : NULL;
+}
+
+static void zini_handle_resolve(ZINI_Handle* handle) {
+    INIFILE* iniFile = handle->iniFile;
+    handle->pair = zini_path_find(iniFile, handle->hash, handle->section, strlen(handle->section), handle->key, strlen(handle->key));
+    handle->generation = iniFile->generation;
+}
+
+ZINI_Handle ZINI_Resolve(INIFILE* iniFile, const char* section, const char* key) {
+    ZINI_Handle handle = {NULL, NULL, NULL, 0, NULL, 0};
+    if (!iniFile || !section || !key) {
+        fprintf(stderr, "INI file or key or section is NULL!\n");
+        return handle;
+    }
+
+    handle.iniFile = iniFile;
+    handle.section = section;
+    handle.key = key;
+    handle.hash = zini_pair_hash(zini_hash(section, strlen(section)), key, strlen(key));
+    zini_handle_resolve(&handle);
+    return handle;
+}
+
+// a missing pair can be added without bumping the generation, so only found pairs are trusted
+const char* ZINI_Read(ZINI_Handle* handle) {
+    if (!handle || !handle->iniFile) return NULL;
+
+    if (!handle->pair || handle->generation != handle->iniFile->generation) zini_handle_resolve(handle);
+    return handle->pair ? handle->pair->value : NULL;
+}
+
+static bool zini_is_digit(char c) {
+    return (unsigned char)(c - '0') < 10;
+}
+
+static bool zini_is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// values keep the blanks around '=' and a '\r' from CRLF files, the typed getters ignore them
+static const char* zini_trim(const char* str, size_t* length) {
+    const char* end = str + *length;
+    while (str < end && zini_is_blank(*str)) str++;
+    while (end > str && zini_is_blank(end[-1])) end--;
+    *length = (size_t)(end - str);
+    return str;
+}
+
+#if ZINI_LITTLE_ENDIAN
+// true when all eight bytes of a little-endian load are ASCII digits
+static bool zini_is_eight_digits(uint64_t chunk) {
+    return ((chunk & 0xF0F0F0F0F0F0F0F0ULL) |
+            (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL;
+}
+
+// converts eight ASCII digits with three multiplications instead of eight dependent steps
+static uint32_t zini_eight_digits(uint64_t chunk) {
+    chunk -= 0x3030303030303030ULL;
+    chunk = chunk * 10 + (chunk >> 8);
+    chunk = (((chunk & 0x000000FF000000FFULL) * 0x000F424000000064ULL) +
+             (((chunk >> 16) & 0x000000FF000000FFULL) * 0x0000271000000001ULL)) >> 32;
+    return (uint32_t)chunk;
+}
+#endif // ZINI_LITTLE_ENDIAN
+
+/*
+ * Appends the digits at *cursor to a mantissa of at most 19 significant digits, so it never overflows.
+ * Digits beyond that are counted in *dropped, and *inexact is set if any of them is not zero.
+ * Returns the number of digits that went into the mantissa.
+ */
+static size_t zini_read_digits(const char** cursor, const char* end, uint64_t* mantissa, int* significant,
+                               size_t* dropped, bool* inexact) {
+    const char* p = *cursor;
+    size_t kept = 0;
+#if ZINI_LITTLE_ENDIAN
+    while (end - p >= 8 && *significant <= 11) {
+        uint64_t chunk;
+        memcpy(&chunk, p, sizeof(chunk));
+        if (!zini_is_eight_digits(chunk)) break;
+        *mantissa = *mantissa * 100000000 + zini_eight_digits(chunk);
+        if (*mantissa) *significant += 8;
+        kept += 8;
+        p += 8;
+    }
+#endif // ZINI_LITTLE_ENDIAN
+    for (; p < end && zini_is_digit(*p); p++) {
+        if (*significant < 19) {
+            *mantissa = *mantissa * 10 + (uint64_t)(*p - '0');
+            if (*mantissa) (*significant)++;
+            kept++;
+        }
+        else {
+            if (*p != '0') *inexact = true;
+            (*dropped)++;
+        }
+    }
+    *cursor = p;
+    return kept;
+}
+
+// parses an optionally signed decimal integer into its sign and magnitude
+static ZINI_Status zini_parse_integer(const char* str, size_t length, bool* negative, uint64_t* magnitude) {
+    str = zini_trim(str, &length);
+    const char* end = str + length;
+
+    *negative = false;
+    if (str < end && (*str == '+' || *str == '-')) *negative = *str++ == '-';
+    if (str == end || !zini_is_digit(*str)) return ZINI_TYPE_ERROR;
+
+    while (str < end && *str == '0') str++;
+
+    uint64_t mantissa = 0;
+    int significant = 0;
+    size_t dropped = 0;
+    bool inexact = false;
+    zini_read_digits(&str, end, &mantissa, &significant, &dropped, &inexact);
+    if (str != end) return ZINI_TYPE_ERROR;
+
+    // a twentieth digit may still fit, anything beyond cannot
+    if (dropped > 1) return ZINI_RANGE_ERROR;
+    if (dropped == 1) {
+        unsigned digit = (unsigned)(end[-1] - '0');
+        if (mantissa > (UINT64_MAX - digit) / 10) return ZINI_RANGE_ERROR;
+        mantissa = mantissa * 10 + digit;
+    }
+
+    *magnitude = mantissa;
+    return ZINI_SUCCESS;
+}
+
+static ZINI_Status zini_parse_int64(const char* str, size_t length, int64_t* value) {
+    bool negative;
+    uint64_t magnitude;
+    ZINI_Status status = zini_parse_integer(str, length, &negative, &magnitude);
+    if (status != ZINI_SUCCESS) return status;
+
+    if (negative) {
+        if (magnitude > (uint64_t)INT64_MAX + 1) return ZINI_RANGE_ERROR;
+        *value = magnitude == (uint64_t)INT64_MAX + 1 ? INT64_MIN : -(int64_t)magnitude;
+    }
+    else {
+        if (magnitude > INT64_MAX) return ZINI_RANGE_ERROR;
+        *value = (int64_t)magnitude;
+    }
+    return ZINI_SUCCESS;
+}
+
+static ZINI_Status zini_parse_uint64(const char* str, size_t length, uint64_t* value) {
+    bool negative;
+    uint64_t magnitude;
+    ZINI_Status status = zini_parse_integer(str, length, &negative, &magnitude);
+    if (status != ZINI_SUCCESS) return status;
+
+    if (negative && magnitude) return ZINI_RANGE_ERROR;
+    *value = magnitude;
+    return ZINI_SUCCESS;
+}
+
+#if ZINI_EXACT_DOUBLE
+static const double zini_powers_of_ten[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+#endif // ZINI_EXACT_DOUBLE
+
+/*
+ * Parses a decimal floating point number. Mantissas of up to 2^53 scaled by at most 10^22 are exact in
+ * a double, so those take one multiplication or division (Clinger's fast path). That covers the values
+ * configs hold, everything else is validated here and handed to strtod.
+ */
+static ZINI_Status zini_parse_double(const char* str, size_t length, double* value) {
+    str = zini_trim(str, &length);
+    const char* start = str;
+    const char* end = str + length;
+
+    bool negative = false;
+    if (str < end && (*str == '+' || *str == '-')) negative = *str++ == '-';
+
+    uint64_t mantissa = 0;
+    int significant = 0;
+    size_t dropped = 0;
+    bool inexact = false;
+    size_t digits = zini_read_digits(&str, end, &mantissa, &significant, &dropped, &inexact);
+    int64_t exponent = (int64_t)dropped;
+    digits += dropped;
+
+    if (str < end && *str == '.') {
+        str++;
+        size_t fractionDropped = 0;
+        size_t kept = zini_read_digits(&str, end, &mantissa, &significant, &fractionDropped, &inexact);
+        exponent -= (int64_t)kept;
+        digits += kept + fractionDropped;
+    }
+    if (digits == 0) return ZINI_TYPE_ERROR;
+
+    if (str < end && (*str == 'e' || *str == 'E')) {
+        str++;
+        bool negativeExponent = false;
+        if (str < end && (*str == '+' || *str == '-')) negativeExponent = *str++ == '-';
+        if (str == end || !zini_is_digit(*str)) return ZINI_TYPE_ERROR;
+
+        int64_t explicitExponent = 0;
+        for (; str < end && zini_is_digit(*str); str++) {
+            if (explicitExponent < 100000) explicitExponent = explicitExponent * 10 + (*str - '0');
+        }
+        exponent += negativeExponent ? -explicitExponent : explicitExponent;
+    }
+    if (str != end) return ZINI_TYPE_ERROR;
+
+    if (mantissa == 0) {
+        *value = negative ? -0.0 : 0.0;
+        return ZINI_SUCCESS;
+    }
+
+#if ZINI_EXACT_DOUBLE
+    if (!inexact && mantissa <= (1ULL << 53) && exponent >= -22 && exponent <= 22) {
+        double result = (double)mantissa;
+        result = exponent < 0 ? result / zini_powers_of_ten[-exponent] : result * zini_powers_of_ten[exponent];
+        *value = negative ? -result : result;
+        return ZINI_SUCCESS;
+    }
+#endif // ZINI_EXACT_DOUBLE
+
+    // values are NUL-terminated and the syntax is checked, so strtod stops exactly at the trimmed end
+    errno = 0;
+    double result = strtod(start, NULL);
+    if (errno == ERANGE && (result > DBL_MAX || result < -DBL_MAX)) return ZINI_RANGE_ERROR;
+    *value = result;
+    return ZINI_SUCCESS;
+}
+
+// packs up to eight lower-cased bytes into one word, so a keyword is matched with one compare
+static uint64_t zini_keyword(const char* str, size_t length) {
+    uint64_t word = 0;
+    for (size_t i = 0; i < length; i++) {
+        char c = str[i];
+        if (c >= 'A' && c <= 'Z') c = (char)(c - 'A' + 'a');
+        word = (word << 8) | (unsigned char)c;
+    }
+    return word;
+}
+
+// accepts true/false, yes/no, on/off and 1/0, in any case
+static ZINI_Status zini_parse_bool(const char* str, size_t length, bool* value) {
+    str = zini_trim(str, &length);
+    if (length == 0 || length > 5) return ZINI_TYPE_ERROR;
+
+    uint64_t word = zini_keyword(str, length);
+    if (word == zini_keyword("true", 4) || word == zini_keyword("yes", 3) ||
+        word == zini_keyword("on", 2) || word == zini_keyword("1", 1)) {
+        *value = true;
+        return ZINI_SUCCESS;
+    }
+    if (word == zini_keyword("false", 5) || word == zini_keyword("no", 2) ||
+        word == zini_keyword("off", 3) || word == zini_keyword("0", 1)) {
+        *value = false;
+        return ZINI_SUCCESS;
+    }
+    return ZINI_TYPE_ERROR;
+}
+
+/*
+ * The pair converters below serve a typed read from the pair's cache when it already holds a value of
+ * the right kind, and otherwise parse the text and, when fill is set, cache the result. Only successful
+ * conversions are cached, and ZINI_SetValue and ZINI_RemovePair drop the cache. Frozen files are not
+ * filled, so that any number of threads may read them.
+ */
+static ZINI_Status zini_pair_int64(Pair* pair, bool fill, int64_t* value) {
+    if (pair->cacheType == ZINI_CACHE_INT) {
+        *value = pair->cache.asInt;
+        return ZINI_SUCCESS;
+    }
+
+    int64_t result;
+    ZINI_Status status = zini_parse_int64(pair->value, pair->valueLength, &result);
+    if (status != ZINI_SUCCESS) return status;
+    if (fill) {
+        pair->cache.asInt = result;
+        pair->cacheType = ZINI_CACHE_INT;
+    }
+    *value = result;
+    return ZINI_SUCCESS;
+}
+
+// unsigned values share the int64 cache, only those above INT64_MAX are parsed on every read
+static ZINI_Status zini_pair_uint64(Pair* pair, bool fill, uint64_t* value) {
+    if (pair->cacheType == ZINI_CACHE_INT) {
+        if (pair->cache.asInt < 0) return ZINI_RANGE_ERROR;
+        *value = (uint64_t)pair->cache.asInt;
+        return ZINI_SUCCESS;
+    }
+
+    uint64_t result;
+    ZINI_Status status = zini_parse_uint64(pair->value, pair->valueLength, &result);
+    if (status != ZINI_SUCCESS) return status;
+    if (fill && result <= INT64_MAX) {
+        pair->cache.asInt = (int64_t)result;
+        pair->cacheType = ZINI_CACHE_INT;
+    }
+    *value = result;
+    return ZINI_SUCCESS;
+}
+
+static ZINI_Status zini_pair_double(Pair* pair, bool fill, double* value) {
+    if (pair->cacheType == ZINI_CACHE_DOUBLE) {
+        *value = pair->cache.asDouble;
+        return ZINI_SUCCESS;
+    }
+
+    double result;
+    ZINI_Status status = zini_parse_double(pair->value, pair->valueLength, &result);
+    if (status != ZINI_SUCCESS) return status;
+    if (fill) {
+        pair->cache.asDouble = result;
+        pair->cacheType = ZINI_CACHE_DOUBLE;
+    }
+    *value = result;
+    return ZINI_SUCCESS;
+}
+
+static ZINI_Status zini_pair_bool(Pair* pair, bool fill, bool* value) {
+    if (pair->cacheType == ZINI_CACHE_BOOL) {
+        *value = pair->cache.asBool;
+        return ZINI_SUCCESS;
+    }
+
+    bool result;
+    ZINI_Status status = zini_parse_bool(pair->value, pair->valueLength, &result);
+    if (status != ZINI_SUCCESS) return status;
+    if (fill) {
+        pair->cache.asBool = result;
+        pair->cacheType = ZINI_CACHE_BOOL;
+    }
+    *value = result;
+    return ZINI_SUCCESS;
+}
+
+static ZINI_Status zini_pair_int(Pair* pair, bool fill, int* value) {
+    int64_t result;
+    ZINI_Status status = zini_pair_int64(pair, fill, &result);
+    if (status != ZINI_SUCCESS) return status;
+    if (result < INT_MIN || result > INT_MAX) return ZINI_RANGE_ERROR;
+    *value = (int)result;
+    return ZINI_SUCCESS;
+}
+
+static ZINI_Status zini_pair_uint(Pair* pair, bool fill, unsigned int* value) {
+    uint64_t result;
+    ZINI_Status status = zini_pair_uint64(pair, fill, &result);
+    if (status != ZINI_SUCCESS) return status;
+    if (result > UINT_MAX) return ZINI_RANGE_ERROR;
+    *value = (unsigned int)result;
+    return ZINI_SUCCESS;
+}
+
+static ZINI_Status zini_pair_float(Pair* pair, bool fill, float* value) {
+    double result;
+    ZINI_Status status = zini_pair_double(pair, fill, &result);
+    if (status != ZINI_SUCCESS) return status;
+    if (result > FLT_MAX || result < -FLT_MAX) return ZINI_RANGE_ERROR;
+    *value = (float)result;
+    return ZINI_SUCCESS;
+}
+
+// finds the pair a typed getter converts, reporting through the status instead of stderr
+static ZINI_Status zini_typed_pair(Section* section, const char* key, const void* value, Pair** pair) {
+    if (!section || !key || !value) return ZINI_INVALID_INPUT;
+    *pair = zini_find_pair(section, key);
+    return *pair ? ZINI_SUCCESS : ZINI_KEY_NOT_FOUND;
+}
+
+// frozen files answer with one probe, only a miss needs the section index to tell which name was missing
+static ZINI_Status zini_typed_pair_ex(INIFILE* iniFile, const char* section, const char* key, const void* value, Pair** pair) {
+    if (!iniFile || !section || !key || !value) return ZINI_INVALID_INPUT;
+
+    size_t sectionLength = strlen(section);
+    if (iniFile->frozen) {
+        *pair = zini_frozen_find(iniFile, section, sectionLength, key, strlen(key));
+        if (*pair) return ZINI_SUCCESS;
+    }
+
+    Section* found = zini_find_section_n(iniFile, section, sectionLength);
+    if (!found) return ZINI_SECTION_NOT_FOUND;
+    return zini_typed_pair(found, key, value, pair);
+}
+
+ZINI_Status ZINI_GetInt(Section* section, const char* key, int* value) {
+    Pair* pair;
+    ZINI_Status status = zini_typed_pair(section, key, value, &pair);
+    return status == ZINI_SUCCESS ? zini_pair_int(pair, !section->owner->frozen, value) : status;
+}
+
+ZINI_Status ZINI_GetInt64(Section* section, const char* key, int64_t* value) {
+    Pair* pair;
+    ZINI_Status status = zini_typed_pair(section, key, value, &pair);
+    return status == ZINI_SUCCESS ? zini_pair_int64(pair, !section->owner->frozen, value) : status;
+}
+
+ZINI_Status ZINI_GetUInt(Section* section, const char* key, unsigned int* value) {
+    Pair* pair;
+    ZINI_Status status = zini_typed_pair(section, key, value, &pair);
+    return status == ZINI_SUCCESS ? zini_pair_uint(pair, !section->owner->frozen, value) : status;
+}
+
+ZINI_Status ZINI_GetDouble(Section* section, const char* key, double* value) {
+    Pair* pair;
+    ZINI_Status status = zini_typed_pair(section, key, value, &pair);
+    return status == ZINI_SUCCESS ? zini_pair_double(pair, !section->owner->frozen, value) : status;
+}
+
+ZINI_Status ZINI_GetFloat(Section* section, const char* key, float* value) {
+    Pair* pair;
+    ZINI_Status status = zini_typed_pair(section, key, value, &pair);
+    return status == ZINI_SUCCESS ? zini_pair_float(pair, !section->owner->frozen, value) : status;
+}
+
+ZINI_Status ZINI_GetBool(Section* section, const char* key, bool* value) {
+    Pair* pair;
+    ZINI_Status status = zini_typed_pair(section, key, value, &pair);
+    return status == ZINI_SUCCESS ? zini_pair_bool(pair, !section->owner->frozen, value) : status;
+}
+
+ZINI_Status ZINI_GetIntEx(INIFILE* iniFile, const char* section, const char* key, int* value) {
+    Pair* pair;
+    ZINI_Status status = zini_typed_pair_ex(iniFile, section, key, value, &pair);
+    return status == ZINI_SUCCESS ? zini_pair_int(pair, !iniFile->frozen, value) : status;
+}
+
+ZINI_Status ZINI_GetInt64Ex(INIFILE* iniFile, const char* section, const char* key, int64_t* value) {
+    Pair* pair;
+    ZINI_Status status = zini_typed_pair_ex(iniFile, section, key, value, &pair);
+    return status == ZINI_SUCCESS ? zini_pair_int64(pair, !iniFile->frozen, value) : status;
+}
+
+ZINI_Status ZINI_GetUIntEx(INIFILE* iniFile, const char* section, const char* key, unsigned int* value) {
+    Pair* pair;
+    ZINI_Status status = zini_typed_pair_ex(iniFile, section, key, value, &pair);
+    return status == ZINI_SUCCESS ? zini_pair_uint(pair, !iniFile->frozen, value) : status;
+}
+
+ZINI_Status ZINI_GetDoubleEx(INIFILE* iniFile, const char* section, const char* key, double* value) {
+    Pair* pair;
+    ZINI_Status status = zini_typed_pair_ex(iniFile, section, key, value, &pair);
+    return status == ZINI_SUCCESS ? zini_pair_double(pair, !iniFile->frozen, value) : status;
+}
+
+ZINI_Status ZINI_GetFloatEx(INIFILE* iniFile, const char* section, const char* key, float* value) {
+    Pair* pair;
+    ZINI_Status status = zini_typed_pair_ex(iniFile, section, key, value, &pair);
+    return status == ZINI_SUCCESS ? zini_pair_float(pair, !iniFile->frozen, value) : status;
+}
+
+ZINI_Status ZINI_GetBoolEx(INIFILE* iniFile, const char* section, const char* key, bool* value) {
+    Pair* pair;
+    ZINI_Status status = zini_typed_pair_ex(iniFile, section, key, value, &pair);
+    return status == ZINI_SUCCESS ? zini_pair_bool(pair, !iniFile->frozen, value) : status;
+}
+
+void ZINI_Clean(INIFILE *iniFile) {
+    if (!iniFile) return;
+    if (iniFile->isModified) printf("INI file was modified but not saved!\n");
+    for (size_t i = 0; i < iniFile->sectionCount; ++i) {
+        free(iniFile->sections[i].pairs);
+        zini_index_free(&iniFile->sections[i].pairIndex);
+    }
+    free(iniFile->sections);
+    iniFile->sections = NULL;
+    iniFile->sectionCount = 0;
+    iniFile->sectionCapacity = 0;
+    iniFile->pairReserve = 0;
+    zini_index_free(&iniFile->sectionIndex);
+    zini_frozen_free(iniFile);
+    zini_path_free(&iniFile->pathIndex);
+    zini_arena_free(iniFile);
+#ifdef ZINI_HAVE_MMAP
+    if (iniFile->mapping) munmap(iniFile->mapping, iniFile->mappingLength);
+#endif // ZINI_HAVE_MMAP
+    iniFile->mapping = NULL;
+    iniFile->mappingLength = 0;
+}
+
+ZINI_Status ZINI_RemovePair(Section* section, const char* key) {
+    if (!section || !key) {
+        fprintf(stderr, "Section or key is NULL!\n");
+        return ZINI_INVALID_INPUT;
+    }
+    if (zini_rejects_changes(section->owner)) return ZINI_FROZEN_ERROR;
+
+    Pair* pair = zini_find_pair(section, key);
+    if (!pair) return ZINI_KEY_NOT_FOUND;
+
+    INIFILE* iniFile = section->owner;
+    size_t sectionPosition = (size_t)(section - iniFile->sections);
+    size_t position = (size_t)(pair - section->pairs);
+    uint64_t sectionHash = zini_hash(section->section, section->sectionLength);
+    zini_index_remove(&section->pairIndex, zini_hash(pair->key, pair->keyLength), position);
+    zini_path_remove(&iniFile->pathIndex, zini_pair_hash(sectionHash, pair->key, pair->keyLength), sectionPosition, position);
+
+    // the pairs behind move down a place to keep their order, and their index entries follow
+    for (size_t j = position + 1; j < section->pairCount; j++) {
+        const Pair* moved = &section->pairs[j];
+        zini_index_move(&section->pairIndex, zini_hash(moved->key, moved->keyLength), j, j - 1);
+        if (iniFile->pathIndex.capacity) {
+            zini_path_move(&iniFile->pathIndex, zini_pair_hash(sectionHash, moved->key, moved->keyLength), sectionPosition, j, j - 1);
+        }
+    }
+    memmove(pair, pair + 1, (section->pairCount - position - 1) * sizeof(Pair));
+    section->pairCount--;
+    section->isModified = true;
+    section->owner->isModified = true;
+    section->owner->generation++;
+    return ZINI_SUCCESS;
+}
+
+ZINI_Status ZINI_RemovePairEx(INIFILE* iniFile, const char* section, const char* key) {
+    if (!iniFile || !key || !section) {
+        fprintf(stderr, "INI file or key or section is NULL!\n");
+        return ZINI_INVALID_INPUT;
+    }
+
+    Section* sec = ZINI_FindSection(iniFile, section);
+    if (!sec) return ZINI_SECTION_NOT_FOUND;
+    return ZINI_RemovePair(sec, key);
+}
+
+ZINI_Status ZINI_SetValue(Section* section, const char* key, const char* newValue) {
+    if (!section || !key || !newValue) {
+        fprintf(stderr, "Section or key or value is NULL!\n");
+        return ZINI_INVALID_INPUT;
+    }
+    if (zini_rejects_changes(section->owner)) return ZINI_FROZEN_ERROR;
+
+    Pair* pair = zini_find_pair(section, key);
+    if (!pair) return ZINI_KEY_NOT_FOUND;
+
+    // the old value stays in the arena, readers holding it are not invalidated
+    size_t length = strlen(newValue);
+    const char* copy = zini_arena_strndup(section->owner, newValue, length);
+    if (!copy) return ZINI_MEMORY_ERROR;
+    pair->value = copy;
+    pair->valueLength = length;
+    pair->isModified = true;
+    pair->cacheType = ZINI_CACHE_NONE;
+    section->isModified = true;
+    section->owner->isModified = true;
+    return ZINI_SUCCESS;
+}
+
+ZINI_Status ZINI_SetValueEx(INIFILE* iniFile, const char* section, const char* key, const char* newValue) {
+    if (!iniFile || !key || !section) {
+        fprintf(stderr, "INI file or key or section is NULL!\n");
+        return ZINI_INVALID_INPUT;
+    }
+
+    Section* sec = ZINI_FindSection(iniFile, section);
+    if (!sec) return ZINI_SECTION_NOT_FOUND;
+    return ZINI_SetValue(sec, key, newValue);
+}
+
+ZINI_Status ZINI_RemoveSection(INIFILE* iniFile, const char* section) {
+    if (!iniFile || !section) {
+        fprintf(stderr, "INI file or section is NULL!\n");
+        return ZINI_INVALID_INPUT;
+    }
+    if (zini_rejects_changes(iniFile)) return ZINI_FROZEN_ERROR;
+
+   Section* sec = ZINI_FindSection(iniFile, section);
+    if (!sec) {
+        fprintf(stderr, "Section not found!\n");
+        return ZINI_SECTION_NOT_FOUND;
+    }
+   size_t position = (size_t)(sec - iniFile->sections);
+   zini_index_remove(&iniFile->sectionIndex, zini_hash(sec->section, sec->sectionLength), position);
+   free(sec->pairs);
+   zini_index_free(&sec->pairIndex);
+
+   // a saved section leaves a span behind that the next incremental save has to cut out
+   if (sec->sourceOffset != ZINI_NO_SOURCE && sec->sourceOffset < iniFile->removedSource) iniFile->removedSource = sec->sourceOffset;
+
+   for (size_t j = position + 1; j < iniFile->sectionCount; j++) {
+       const Section* moved = &iniFile->sections[j];
+       zini_index_move(&iniFile->sectionIndex, zini_hash(moved->section, moved->sectionLength), j, j - 1);
+   }
+   memmove(sec, sec + 1, (iniFile->sectionCount - position - 1) * sizeof(Section));
+   iniFile->sectionCount--;
+
+   // every pair behind the section changed its position, the next lookup rebuilds the path index
+   zini_path_free(&iniFile->pathIndex);
+   iniFile->isModified = true;
+   iniFile->generation++;
+   return ZINI_SUCCESS;
+}
+
+bool ZINI_SectionExists(INIFILE* iniFile, const char* section) {
+    if (!iniFile || !section) {
+        fprintf(stderr, "INI file or section is NULL!\n");
+        return false;
+    }
+
+    if (ZINI_FindSection(iniFile, section)) return true;
+
+    return false;
+}
+
+bool ZINI_KeyExists(Section* section, const char* key) {
+    if (!section || !key) {
+        fprintf(stderr, "Section or key is NULL!\n");
+        return false;
+    }
+    return zini_find_pair(section, key) != NULL;
+}
+
+void ZINI_Print(INIFILE* iniFile, FILE* stream) {
+    if (!stream || !iniFile) {
+        fprintf(stderr, "INI File or Stream is NULL!\n");
+        return;
+    }
+
+    size_t length;
+    char* buffer = zini_render(iniFile, &length);
+    if (!buffer) return;
+
+    if (stream == stdout) fprintf(stream, "===================================\n");
+    fwrite(buffer, 1, length, stream);
+    if (stream == stdout) fprintf(stream, "===================================\n");
+
+    free(buffer);
+}
+
+bool ZINI_Clone(const INIFILE* source, INIFILE* copy) {
+    if (!source || !copy) {
+        fprintf(stderr, "Source or copy is NULL!\n");
+        return false;
+    }
+
+    ZINI_Init(copy);
+    bool ok = zini_reserve_sections(copy, source->sectionCount) &&
+              zini_index_reserve(&copy->sectionIndex, source->sectionCount);
+    for (size_t i = 0; i < source->sectionCount && ok; i++) {
+        const Section* from = &source->sections[i];
+        Section* to = zini_add_section_n(copy, from->section, from->sectionLength, false);
+        ok = to && zini_reserve_pairs(to, from->pairCount);
+        for (size_t j = 0; j < from->pairCount && ok; j++) {
+            const Pair* pair = &from->pairs[j];
+            Pair* added = zini_add_pair_n(to, pair->key, pair->keyLength, pair->value, pair->valueLength, false);
+            ok = added != NULL;
+            if (!ok) break;
+            // the cache only depends on the value, so conversions done on the source carry over
+            added->isModified = pair->isModified;
+            added->cacheType = pair->cacheType;
+            added->cache = pair->cache;
+        }
+        if (!ok) break;
+        to->isModified = from->isModified;
+        to->sourceOffset = from->sourceOffset;
+        to->sourceLength = from->sourceLength;
+    }
+
+    if (!ok) {
+        copy->isModified = false;
+        ZINI_Clean(copy);
         return false;
     }
 
-    char line[MAX_LINE_LENGTH];
-    Section* currentSection = NULL;
+    copy->pairReserve = source->pairReserve;
+    copy->isModified = source->isModified;
+    copy->sourceSize = source->sourceSize;
+    copy->sourceFile = source->sourceFile;
+    copy->removedSource = source->removedSource;
+    copy->floatFormat = source->floatFormat;
+    copy->maxSectionLength = source->maxSectionLength;
+    return true;
+}
+
+/*
+ * ZINI_Shared is epoch based read-copy-update. Each published version is frozen and never changes
+ * again. A reader announces the epoch it enters in before loading the current version, so a version
+ * replaced in epoch e can no longer be reached by readers that announced e or later, and is freed once
+ * every reader inside announced at least e. All atomics are sequentially consistent, which makes the
+ * reader's announce-then-load and the writer's swap-then-scan see each other in one order.
+ */
+typedef struct INISharedVersion {
+    INIFILE file;
+    uint64_t retiredIn;             // epoch the version was replaced in
+    struct INISharedVersion* next;  // next retired version
+} ZINI_SharedVersion;
 
-    while (fgets(line, MAX_LINE_LENGTH, file)) {
-        line[strcspn(line, "\n")] = 0;
-        if (line[0] == '\0' || line[0] == ';') continue;
+// one cache line per reader, so readers entering and leaving do not slow each other down
+typedef struct {
+    uint64_t epoch;     // epoch the reader entered in, 0 while it is outside
+    int used;
+    char padding[64 - sizeof(uint64_t) - sizeof(int)];
+} ZINI_SharedReader;
 
-        if (line[0] == '[') {
-            char *end = strchr(line, ']');
-            if (end) {
-                *end = '\0';
-                Section* section = NULL;
-                for (int i = 0; i < iniFile->sectionCount; i++) {
-                    if (strcmp(iniFile->sections[i].section, line + 1) == 0) {
-                        section = &iniFile->sections[i];
-                        break;
-                    }
-                }
+struct INIShared {
+    ZINI_SharedReader readers[ZINI_SHARED_READERS];
+    ZINI_SharedVersion* current;
+    uint64_t epoch;
+    ZINI_SharedVersion* retired;
+#ifdef ZINI_HAVE_PTHREADS
+    pthread_mutex_t writerLock;
+#endif // ZINI_HAVE_PTHREADS
+};
 
-                if (!section) currentSection = ZINI_AddSection(iniFile, line+1);
-                else currentSection = section;
-            }
+static void zini_shared_lock(ZINI_Shared* shared) {
+#ifdef ZINI_HAVE_PTHREADS
+    pthread_mutex_lock(&shared->writerLock);
+#else
+    (void)shared;
+#endif // ZINI_HAVE_PTHREADS
+}
+
+static void zini_shared_unlock(ZINI_Shared* shared) {
+#ifdef ZINI_HAVE_PTHREADS
+    pthread_mutex_unlock(&shared->writerLock);
+#else
+    (void)shared;
+#endif // ZINI_HAVE_PTHREADS
+}
+
+// sections point back to their INIFILE, so a file changing address has them follow
+static void zini_move_file(INIFILE* to, INIFILE* from) {
+    *to = *from;
+    for (size_t i = 0; i < to->sectionCount; i++) to->sections[i].owner = to;
+    ZINI_Init(from);
+}
+
+static void zini_shared_free_version(ZINI_SharedVersion* version) {
+    // published versions are not expected to be saved
+    version->file.isModified = false;
+    ZINI_Clean(&version->file);
+    free(version);
+}
+
+// frees the retired versions no reader can still be inside, called with the writer lock held
+static void zini_shared_reclaim(ZINI_Shared* shared) {
+    uint64_t oldest = UINT64_MAX;
+    for (int i = 0; i < ZINI_SHARED_READERS; i++) {
+        uint64_t epoch = ZINI_ATOMIC_LOAD(&shared->readers[i].epoch);
+        if (epoch && epoch < oldest) oldest = epoch;
+    }
+
+    ZINI_SharedVersion** link = &shared->retired;
+    while (*link) {
+        ZINI_SharedVersion* version = *link;
+        if (version->retiredIn <= oldest) {
+            *link = version->next;
+            zini_shared_free_version(version);
         }
         else {
-            char* delimiter = strchr(line, '=');
-            if (delimiter) {
-                *delimiter = '\0';
-                if (currentSection) {
-                    ZINI_AddPair(currentSection, line, delimiter + 1);
-                }
-            }
+            link = &version->next;
         }
     }
-    fclose(file);
-    return true;
 }
 
-bool ZINI_Save(INIFILE* iniFile, const char* filename) {
-    FILE *file = fopen(filename, "w");
-    if (!file) {
-        perror("Error opening INI file for writing");
-        return false;
+// freezes next and moves it into a new version, with next left untouched on failure
+static ZINI_SharedVersion* zini_shared_version(INIFILE* next) {
+    ZINI_SharedVersion* version = (ZINI_SharedVersion*)malloc(sizeof(ZINI_SharedVersion));
+    if (!version) {
+        perror("Failed to allocate memory for shared version");
+        return NULL;
     }
-    
-    ZINI_Print(iniFile, file);
-    iniFile->isModified = false;
-    fclose(file);
+    if (!ZINI_Freeze(next)) {
+        free(version);
+        return NULL;
+    }
+    zini_move_file(&version->file, next);
+    version->retiredIn = 0;
+    version->next = NULL;
+    return version;
+}
+
+static bool zini_shared_publish(ZINI_Shared* shared, INIFILE* next) {
+    ZINI_SharedVersion* version = zini_shared_version(next);
+    if (!version) return false;
+
+    ZINI_SharedVersion* old = ZINI_ATOMIC_EXCHANGE(&shared->current, version);
+    old->retiredIn = ZINI_ATOMIC_INCREMENT(&shared->epoch);
+    old->next = shared->retired;
+    shared->retired = old;
+    zini_shared_reclaim(shared);
     return true;
 }
 
-Section* ZINI_AddSection(INIFILE* iniFile, const char* section) {
-    if (!iniFile || !section) {
-        fprintf(stderr, "INIFIle or Sections is NULL!\n");
+ZINI_Shared* ZINI_SharedCreate(INIFILE* initial) {
+    if (!initial) {
+        fprintf(stderr, "INI file is NULL!\n");
         return NULL;
     }
 
-    if (ZINI_SectionExists(iniFile, section)) {
-        fprintf(stderr, "Sections Exist!\n");
+    ZINI_Shared* shared = (ZINI_Shared*)calloc(1, sizeof(ZINI_Shared));
+    if (!shared) {
+        perror("Failed to allocate memory for shared INI file");
         return NULL;
     }
-
-    Section* newptr = (Section*)realloc(iniFile->sections, (iniFile->sectionCount+1) * sizeof(Section));
-    if (!newptr) {
-        perror("Failed to allocate memory for sections");
+#ifdef ZINI_HAVE_PTHREADS
+    if (pthread_mutex_init(&shared->writerLock, NULL) != 0) {
+        fprintf(stderr, "Failed to create writer lock!\n");
+        free(shared);
         return NULL;
     }
+#endif // ZINI_HAVE_PTHREADS
 
-    iniFile->sections = newptr;
-    Section *newSection = &iniFile->sections[iniFile->sectionCount++];
-    strncpy(newSection->section, section, MAX_SECTION_LENGTH - 1);
-    newSection->section[MAX_SECTION_LENGTH - 1] = '\0';
-    newSection->pairs = NULL;
-    newSection->pairCount = 0;
-    iniFile->isModified = true;
-    return newSection;
+    shared->current = zini_shared_version(initial);
+    if (!shared->current) {
+#ifdef ZINI_HAVE_PTHREADS
+        pthread_mutex_destroy(&shared->writerLock);
+#endif // ZINI_HAVE_PTHREADS
+        free(shared);
+        return NULL;
+    }
+    shared->epoch = 1;
+    return shared;
 }
 
-Pair* ZINI_AddPair(Section* section, const char* key, const char* value) { // didnt add code to check if it was modified
-    if (!section || !key || !value) {
-        fprintf(stderr, "Section or Key or Value is NULL!\n");
-        return NULL;
+void ZINI_SharedDestroy(ZINI_Shared* shared) {
+    if (!shared) return;
+
+    while (shared->retired) {
+        ZINI_SharedVersion* next = shared->retired->next;
+        zini_shared_free_version(shared->retired);
+        shared->retired = next;
     }
+    zini_shared_free_version(shared->current);
+#ifdef ZINI_HAVE_PTHREADS
+    pthread_mutex_destroy(&shared->writerLock);
+#endif // ZINI_HAVE_PTHREADS
+    free(shared);
+}
 
-    if (ZINI_KeyExists(section, key)) {
-        fprintf(stderr, "Key Exist!\n");
-        return NULL;
+int ZINI_SharedRegister(ZINI_Shared* shared) {
+    if (!shared) {
+        fprintf(stderr, "Shared INI file is NULL!\n");
+        return -1;
     }
 
-    Pair* newptr = realloc(section->pairs, (section->pairCount + 1) * sizeof(Pair));
-    if (!newptr) {
-        perror("Failed to allocate memory for pairs");
-        return NULL;
+    for (int i = 0; i < ZINI_SHARED_READERS; i++) {
+        if (ZINI_ATOMIC_CLAIM(&shared->readers[i].used)) return i;
     }
+    fprintf(stderr, "No reader slot left!\n");
+    return -1;
+}
 
-    section->pairs = newptr;
-    Pair* newPair = &section->pairs[section->pairCount++];
-    strncpy(newPair->key, key, MAX_KEY_LENGTH - 1);
-    newPair->key[MAX_KEY_LENGTH - 1] = '\0';
-    strncpy(newPair->value, value, MAX_VALUE_LENGTH - 1);
-    newPair->value[MAX_VALUE_LENGTH - 1] = '\0';
-    return newPair;
+void ZINI_SharedUnregister(ZINI_Shared* shared, int reader) {
+    if (!shared || reader < 0 || reader >= ZINI_SHARED_READERS) return;
+    ZINI_ATOMIC_STORE(&shared->readers[reader].epoch, 0);
+    ZINI_ATOMIC_STORE(&shared->readers[reader].used, 0);
 }
 
-Pair* ZINI_AddPairEx(INIFILE* iniFile, const char* section, const char* key, const char* value) { // didnt add code to check if it was modified
-    if (!iniFile || !section || !key || !value) {
-        fprintf(stderr, "INI File or Section or Key or Value is NULL!\n");
+INIFILE* ZINI_SharedAcquire(ZINI_Shared* shared, int reader) {
+    if (!shared || reader < 0 || reader >= ZINI_SHARED_READERS) {
+        fprintf(stderr, "Shared INI file or reader is invalid!\n");
         return NULL;
     }
 
-    Section* sec = ZINI_FindSection(iniFile, section);
-    if (!sec) return NULL;
-    Pair* newPair = ZINI_AddPair(sec, key, value);
-    return newPair;
+    ZINI_ATOMIC_STORE(&shared->readers[reader].epoch, ZINI_ATOMIC_LOAD(&shared->epoch));
+    return &ZINI_ATOMIC_LOAD(&shared->current)->file;
 }
 
-Pair* ZINI_AddPairVT(Section* section, const char* key, void* value, ZINI_DType type) {
-    if (!section || !key || !value) {
-        fprintf(stderr, "Sections or key or value is NULL!\n");
-        return NULL;
-    }
+void ZINI_SharedRelease(ZINI_Shared* shared, int reader) {
+    if (!shared || reader < 0 || reader >= ZINI_SHARED_READERS) return;
+    ZINI_ATOMIC_STORE(&shared->readers[reader].epoch, 0);
+}
 
-    Pair* newptr = realloc(section->pairs, (section->pairCount + 1) * sizeof(Pair));
-    if (!newptr) {
-        perror("Failed to allocate memory for pairs");
-        return NULL;
+bool ZINI_SharedPublish(ZINI_Shared* shared, INIFILE* next) {
+    if (!shared || !next) {
+        fprintf(stderr, "Shared INI file or INI file is NULL!\n");
+        return false;
     }
 
-    section->pairs = newptr;
-    Pair* newPair = &section->pairs[section->pairCount++];
-    strncpy(newPair->key, key, MAX_KEY_LENGTH - 1);
-    newPair->key[MAX_KEY_LENGTH - 1] = '\0';
+    zini_shared_lock(shared);
+    bool ok = zini_shared_publish(shared, next);
+    zini_shared_unlock(shared);
+    return ok;
+}
 
-    switch (type) {
-        case ZINI_STR:
-            strncpy(newPair->value, value, MAX_VALUE_LENGTH - 1);
-            newPair->value[MAX_VALUE_LENGTH - 1] = '\0';
-            break;
-        case ZINI_INT:
-            snprintf(newPair->value, MAX_VALUE_LENGTH, "%d", *(int*)value);
-            break;
-        case ZINI_LINT:
-            snprintf(newPair->value, MAX_VALUE_LENGTH, "%ld", *(long int*)value);
-            break;
-        case ZINI_LLINT:
-            snprintf(newPair->value, MAX_VALUE_LENGTH, "%lld", *(long long int*)value);
-            break;
-        case ZINI_UINT:
-            snprintf(newPair->value, MAX_VALUE_LENGTH, "%u", *(unsigned int*)value);
-            break;
-        case ZINI_FLOAT:
-            snprintf(newPair->value, MAX_VALUE_LENGTH, "%.*f", MAX_FLOAT_PRECISION, *(float*)value);
-            break;
-        case ZINI_DOUBLE:
-            snprintf(newPair->value, MAX_VALUE_LENGTH, "%.*f", MAX_DOUBLE_PRECISION, *(double*)value);
-            break;
-        case ZINI_BOOL:
-            snprintf(newPair->value, MAX_VALUE_LENGTH, "%s", (*(bool*)value) ? "true" : "false");
-            break;
-        default:
-            fprintf(stderr, "Data Type Error!\n");
-            return NULL;
+bool ZINI_SharedUpdate(ZINI_Shared* shared, bool (*edit)(INIFILE* copy, void* context), void* context) {
+    if (!shared || !edit) {
+        fprintf(stderr, "Shared INI file or edit function is NULL!\n");
+        return false;
     }
 
-    return newPair;
+    zini_shared_lock(shared);
+    // only writers replace the current version, so holding the lock keeps it alive
+    INIFILE copy;
+    bool ok = ZINI_Clone(&shared->current->file, &copy) && edit(&copy, context) && zini_shared_publish(shared, &copy);
+    zini_shared_unlock(shared);
+
+    copy.isModified = false;
+    ZINI_Clean(&copy);
+    return ok;
 }
 
-Pair* ZINI_AddPairVTEx(INIFILE* iniFile, const char* section, const char* key, void* value, ZINI_DType type) {
-    if (!section || !key || !value) {
-        fprintf(stderr, "INI File or Sections or Key or Value is NULL!\n");
-        return NULL;
+static bool zini_change_push(ZINI_ChangeSet* set, ZINI_ChangeType type, const char* section, const char* key,
+                             const char* oldValue, const char* newValue) {
+    if (set->count == set->capacity) {
+        size_t capacity = zini_grow_capacity(set->capacity);
+        ZINI_Change* changes = (ZINI_Change*)realloc(set->changes, capacity * sizeof(ZINI_Change));
+        if (!changes) {
+            perror("Failed to allocate memory for changes");
+            return false;
+        }
+        set->changes = changes;
+        set->capacity = capacity;
     }
 
-    Section* sec = ZINI_FindSection(iniFile, section);
-    if (!sec) return NULL;
-    Pair* newPair = ZINI_AddPairVT(sec, key, value, type);
-    return newPair;
+    ZINI_Change* change = &set->changes[set->count++];
+    change->type = type;
+    change->section = section;
+    change->key = key;
+    change->oldValue = oldValue;
+    change->newValue = newValue;
+    return true;
 }
 
-Section* ZINI_FindSection(INIFILE* iniFile, const char* section) {
-    if (!iniFile || !section) {
-        fprintf(stderr, "INI file or section name is NULL!\n");
-        return NULL;
+static bool zini_values_equal(const Pair* a, const Pair* b) {
+    return a->valueLength == b->valueLength && memcmp(a->value, b->value, a->valueLength) == 0;
+}
+
+// records every live pair of a section that only one side has
+static bool zini_diff_whole_section(const Section* section, ZINI_ChangeType type, ZINI_ChangeSet* set, bool sections) {
+    if (sections && !zini_change_push(set, type, section->section, NULL, NULL, NULL)) return false;
+    for (size_t j = 0; j < section->pairCount; j++) {
+        const Pair* pair = &section->pairs[j];
+        const char* oldValue = type == ZINI_CHANGE_REMOVED ? pair->value : NULL;
+        const char* newValue = type == ZINI_CHANGE_ADDED ? pair->value : NULL;
+        if (!zini_change_push(set, type, section->section, pair->key, oldValue, newValue)) return false;
     }
+    return true;
+}
+
+/*
+ * Appends every difference between two files, walking each once and looking its sections and pairs up
+ * in the other through the indexes, so the cost is linear in the number of pairs. With sections unset
+ * only pair records are made.
+ */
+static bool zini_diff(INIFILE* from, INIFILE* to, ZINI_ChangeSet* set, bool sections) {
+    for (size_t i = 0; i < to->sectionCount; i++) {
+        Section* section = &to->sections[i];
+        Section* old = zini_find_section_n(from, section->section, section->sectionLength);
+        if (!old) {
+            if (!zini_diff_whole_section(section, ZINI_CHANGE_ADDED, set, sections)) return false;
+            continue;
+        }
+
+        // the section record goes in first and is taken back out if no pair turns out to differ
+        size_t mark = set->count;
+        if (sections && !zini_change_push(set, ZINI_CHANGE_MODIFIED, section->section, NULL, NULL, NULL)) return false;
 
-    for (int i = 0; i < iniFile->sectionCount; i++) {
-        if (strcmp(iniFile->sections[i].section, section) == 0) {
-            return &iniFile->sections[i];
+        for (size_t j = 0; j < section->pairCount; j++) {
+            const Pair* pair = &section->pairs[j];
+            const Pair* oldPair = zini_find_pair_n(old, pair->key, pair->keyLength);
+            if (oldPair && zini_values_equal(oldPair, pair)) continue;
+
+            ZINI_ChangeType type = oldPair ? ZINI_CHANGE_MODIFIED : ZINI_CHANGE_ADDED;
+            if (!zini_change_push(set, type, section->section, pair->key, oldPair ? oldPair->value : NULL, pair->value)) return false;
+        }
+
+        for (size_t j = 0; j < old->pairCount; j++) {
+            const Pair* pair = &old->pairs[j];
+            if (zini_find_pair_n(section, pair->key, pair->keyLength)) continue;
+            if (!zini_change_push(set, ZINI_CHANGE_REMOVED, section->section, pair->key, pair->value, NULL)) return false;
         }
+
+        if (sections && set->count == mark + 1) set->count = mark;
     }
-    
-    return NULL;
+
+    for (size_t i = 0; i < from->sectionCount; i++) {
+        const Section* section = &from->sections[i];
+        if (zini_find_section_n(to, section->section, section->sectionLength)) continue;
+        if (!zini_diff_whole_section(section, ZINI_CHANGE_REMOVED, set, sections)) return false;
+    }
+    return true;
 }
 
-const char* ZINI_GetValue(Section* section, const char* key) {
-    if (!section || !key) {
-        fprintf(stderr, "Section or key is NULL!\n");
-        return NULL;
+ZINI_Status ZINI_Diff(const INIFILE* from, const INIFILE* to, ZINI_ChangeSet* result) {
+    if (!from || !to || !result) {
+        fprintf(stderr, "INI file or change set is NULL!\n");
+        return ZINI_INVALID_INPUT;
     }
 
-    for (int i = 0; i < section->pairCount; i++) {
-        if (strcmp(section->pairs[i].key, key) == 0) {
-            return section->pairs[i].value;
-        }
+    result->changes = NULL;
+    result->count = 0;
+    result->capacity = 0;
+    // both files are only looked up in, the lookup helpers just are not const
+    if (!zini_diff((INIFILE*)from, (INIFILE*)to, result, true)) {
+        ZINI_FreeChangeSet(result);
+        return ZINI_MEMORY_ERROR;
     }
+    return ZINI_SUCCESS;
+}
 
-    fprintf(stderr, "Key doesn't exist!\n");
-    return NULL;
+void ZINI_FreeChangeSet(ZINI_ChangeSet* changes) {
+    if (!changes) return;
+    free(changes->changes);
+    changes->changes = NULL;
+    changes->count = 0;
+    changes->capacity = 0;
 }
 
-const char* ZINI_GetValueEx(INIFILE* iniFile, const char* section, const char* key) {
-    if (!iniFile || !key || !section) {
-        fprintf(stderr, "INI file or key or section is NULL!\n");
-        return NULL;
+/*
+ * Merged index of an overlay: one entry per distinct (section, key), in the order keys first appear from
+ * the base up, pointing at the pair of the topmost layer that has it. The slot table maps hashes to
+ * entries by linear probing.
+ */
+typedef struct {
+    uint64_t hash;
+    const Section* section;     // section of the winning layer, its name is the same in every layer
+    const Pair* pair;
+} ZINI_OverlayEntry;
+
+struct INIOverlay {
+    const INIFILE** layers;
+    size_t layerCount;
+    ZINI_OverlayEntry* entries;
+    size_t entryCount;
+    size_t* slots;              // entry position plus one, 0 marks an empty slot
+    size_t capacity;
+};
+
+static size_t* zini_overlay_slot(const ZINI_OverlayView* view, uint64_t hash, const char* section, size_t sectionLength,
+                                 const char* key, size_t keyLength) {
+    size_t mask = view->capacity - 1;
+    size_t i = hash & mask;
+    for (; view->slots[i]; i = (i + 1) & mask) {
+        const ZINI_OverlayEntry* entry = &view->entries[view->slots[i] - 1];
+        if (entry->hash != hash) continue;
+        if (entry->pair->keyLength == keyLength && entry->section->sectionLength == sectionLength &&
+            memcmp(entry->pair->key, key, keyLength) == 0 && memcmp(entry->section->section, section, sectionLength) == 0) break;
     }
+    return &view->slots[i];
+}
 
-    const char* value = ZINI_GetValue(ZINI_FindSection(iniFile, section), key);
-    return value;
+void ZINI_OverlayFree(ZINI_OverlayView* view) {
+    if (!view) return;
+    free(view->layers);
+    free(view->entries);
+    free(view->slots);
+    free(view);
 }
 
+ZINI_OverlayView* ZINI_Overlay(const INIFILE* const* layers, size_t count) {
+    if (!layers) {
+        fprintf(stderr, "Layers are NULL!\n");
+        return NULL;
+    }
 
-void ZINI_Clean(INIFILE *iniFile) {
-    if (!iniFile) return;
-    if (iniFile->isModified) printf("INI file was modified but not saved!\n");
-    for (int i = 0; i < iniFile->sectionCount; ++i) {
-        free(iniFile->sections[i].pairs);
+    size_t pairs = 0;
+    for (size_t l = 0; l < count; l++) {
+        if (!layers[l]) {
+            fprintf(stderr, "Layer is NULL!\n");
+            return NULL;
+        }
+        for (size_t i = 0; i < layers[l]->sectionCount; i++) pairs += layers[l]->sections[i].pairCount;
     }
-    free(iniFile->sections);
-    iniFile->sections = NULL;
-    iniFile->sectionCount = 0;
-}
 
-void ZINI_RemovePair(Section* section, const char* key) {
-    if (!section || !key) {
-        fprintf(stderr, "Section or key is NULL!\n");
-        return;
+    // sized for every pair up front, so the table never grows and stays at most half full
+    size_t capacity = ZINI_INDEX_MIN_CAPACITY;
+    while (pairs * 2 > capacity) capacity *= 2;
+
+    ZINI_OverlayView* view = (ZINI_OverlayView*)calloc(1, sizeof(ZINI_OverlayView));
+    if (view) {
+        view->layers = (const INIFILE**)malloc((count ? count : 1) * sizeof(INIFILE*));
+        view->entries = (ZINI_OverlayEntry*)malloc((pairs ? pairs : 1) * sizeof(ZINI_OverlayEntry));
+        view->slots = (size_t*)calloc(capacity, sizeof(size_t));
+    }
+    if (!view || !view->layers || !view->entries || !view->slots) {
+        perror("Failed to allocate memory for overlay");
+        ZINI_OverlayFree(view);
+        return NULL;
     }
+    memcpy(view->layers, layers, count * sizeof(INIFILE*));
+    view->layerCount = count;
+    view->capacity = capacity;
+
+    for (size_t l = 0; l < count; l++) {
+        const INIFILE* layer = layers[l];
+        for (size_t i = 0; i < layer->sectionCount; i++) {
+            const Section* section = &layer->sections[i];
+            uint64_t sectionHash = zini_hash(section->section, section->sectionLength);
 
-    for (int i = 0; i < section->pairCount; i++) {
-        if (strcmp(section->pairs[i].key, key) == 0) {
-            section->pairs[i].key[0] = '\0';
-            section->pairs[i].value[0] = '\0';
+            for (size_t j = 0; j < section->pairCount; j++) {
+                const Pair* pair = &section->pairs[j];
+                uint64_t hash = zini_pair_hash(sectionHash, pair->key, pair->keyLength);
+                size_t* slot = zini_overlay_slot(view, hash, section->section, section->sectionLength, pair->key, pair->keyLength);
+                if (*slot) {
+                    // a later layer overrides the value but keeps the position of the first appearance
+                    view->entries[*slot - 1].section = section;
+                    view->entries[*slot - 1].pair = pair;
+                    continue;
+                }
+                ZINI_OverlayEntry* entry = &view->entries[view->entryCount++];
+                entry->hash = hash;
+                entry->section = section;
+                entry->pair = pair;
+                *slot = view->entryCount;
+            }
         }
     }
+    return view;
 }
 
-void ZINI_RemovePairEx(INIFILE* iniFile, const char* section, const char* key) {
-    if (!iniFile || !key || !section) {
-        fprintf(stderr, "INI file or key or section is NULL!\n");
-        return;
+const char* ZINI_OverlayGet(const ZINI_OverlayView* view, const char* section, const char* key) {
+    if (!view || !section || !key) {
+        fprintf(stderr, "Overlay or key or section is NULL!\n");
+        return NULL;
     }
-    ZINI_RemovePair(ZINI_FindSection(iniFile, section), key);
+
+    size_t sectionLength = strlen(section);
+    size_t keyLength = strlen(key);
+    uint64_t hash = zini_pair_hash(zini_hash(section, sectionLength), key, keyLength);
+    size_t slot = *zini_overlay_slot(view, hash, section, sectionLength, key, keyLength);
+    return slot ? view->entries[slot - 1].pair->value : NULL;
 }
 
-void ZINI_SetValue(Section* section, const char* key, const char* newValue) {
-    if (!section || !key) {
-        fprintf(stderr, "Section or key is NULL!\n");
-        return;
+bool ZINI_Flatten(const ZINI_OverlayView* view, INIFILE* flat) {
+    if (!view || !flat) {
+        fprintf(stderr, "Overlay or INI file is NULL!\n");
+        return false;
     }
-    for (int i = 0; i < section->pairCount; i++) {
-        if (strcmp(section->pairs[i].key, key) == 0) {
-            strncpy(section->pairs[i].value, newValue, MAX_VALUE_LENGTH-1);
-            section->pairs[i].value[MAX_VALUE_LENGTH - 1] = '\0';
+
+    ZINI_Init(flat);
+    bool ok = true;
+
+    // sections first, so those without pairs are kept and the order is that of first appearance
+    for (size_t l = 0; l < view->layerCount && ok; l++) {
+        const INIFILE* layer = view->layers[l];
+        for (size_t i = 0; i < layer->sectionCount && ok; i++) {
+            const Section* section = &layer->sections[i];
+            if (zini_find_section_n(flat, section->section, section->sectionLength)) continue;
+            ok = zini_add_section_n(flat, section->section, section->sectionLength, false) != NULL;
         }
     }
-}
 
-void ZINI_SetValueEx(INIFILE* iniFile, const char* section, const char* key, const char* newValue) {
-    if (!iniFile || !key || !section) {
-        fprintf(stderr, "INI file or key or section is NULL!\n");
-        return;
+    // then every section gets exactly the room its winning pairs need
+    size_t* counts = NULL;
+    if (ok) {
+        counts = (size_t*)calloc(flat->sectionCount + 1, sizeof(size_t));
+        ok = counts != NULL;
+        if (!ok) perror("Failed to allocate memory for overlay");
+    }
+    for (size_t e = 0; e < view->entryCount && ok; e++) {
+        const Section* section = view->entries[e].section;
+        counts[zini_find_section_n(flat, section->section, section->sectionLength) - flat->sections]++;
+    }
+    for (size_t i = 0; i < flat->sectionCount && ok; i++) {
+        ok = counts[i] == 0 || zini_reserve_pairs(&flat->sections[i], counts[i]);
     }
 
-    ZINI_SetValue(ZINI_FindSection(iniFile, section), key, newValue);
-}
+    for (size_t e = 0; e < view->entryCount && ok; e++) {
+        const ZINI_OverlayEntry* entry = &view->entries[e];
+        Section* section = zini_find_section_n(flat, entry->section->section, entry->section->sectionLength);
+        ok = zini_add_pair_n(section, entry->pair->key, entry->pair->keyLength, entry->pair->value, entry->pair->valueLength, false) != NULL;
+    }
+    free(counts);
 
-void ZINI_RemoveSection(INIFILE* iniFile, const char* section) {
-    if (!iniFile || !section) {
-        fprintf(stderr, "INI file or section is NULL!\n");
-        return;
+    if (!ok) {
+        flat->isModified = false;
+        ZINI_Clean(flat);
+        return false;
     }
 
-   Section* sec = ZINI_FindSection(iniFile, section);
-    if (!sec) {
-        fprintf(stderr, "Section not found!\n");
+    // a merge of files as they are holds no unsaved change of its own
+    zini_mark_clean(flat);
+    return true;
+}
+
+#if defined(ZINI_HAVE_INOTIFY) && defined(ZINI_HAVE_PTHREADS)
+struct INIWatcher {
+    ZINI_Shared* shared;
+    char* path;
+    const char* name;       // file name part of path, inotify reports names relative to the directory
+    ZINI_WatchCallback callback;
+    void* context;
+    int reader;             // reader slot keeping the old version alive while the callback runs
+    int notifyFd;
+    int stopPipe[2];
+    pthread_t thread;
+};
+
+static void zini_watch_reload(ZINI_Watcher* watcher) {
+    // a private mapping would show later writes to the file, a published version must not change
+    INIFILE next;
+    bool loaded = ZINI_Open(&next, watcher->path);
+
+    // ZINI_Open reads a missing file as an empty one; while the file is deleted or being replaced the
+    // current version stays, and the stamp tells the cases apart since a file that exists has an inode
+    if (!loaded || next.sourceFile.inode == 0) {
+        next.isModified = false;
+        ZINI_Clean(&next);
         return;
     }
-   free(sec->pairs);
-   sec->pairCount = 0;
-   sec->section[0] = '\0';
+
+    ZINI_Shared* shared = watcher->shared;
+    ZINI_ChangeSet changes = {NULL, 0, 0};
+
+    // entering before the publish keeps both versions alive until the callback has seen the changes
+    ZINI_SharedAcquire(shared, watcher->reader);
+    zini_shared_lock(shared);
+    bool publish = zini_diff(&shared->current->file, &next, &changes, false) && changes.count &&
+                   zini_shared_publish(shared, &next);
+    zini_shared_unlock(shared);
+
+    if (publish && watcher->callback) watcher->callback(shared, changes.changes, changes.count, watcher->context);
+    ZINI_SharedRelease(shared, watcher->reader);
+
+    ZINI_FreeChangeSet(&changes);
+    next.isModified = false;
+    ZINI_Clean(&next);
 }
 
-bool ZINI_SectionExists(INIFILE* iniFile, const char* section) {
-    if (!iniFile || !section) {
-        fprintf(stderr, "INI file or section is NULL!\n");
-        return false;
+static bool zini_watch_matches(ZINI_Watcher* watcher) {
+    // the union keeps the buffer aligned for the events read into it
+    union {
+        struct inotify_event event;
+        char bytes[4096];
+    } buffer;
+    bool matches = false;
+
+    for (;;) {
+        ssize_t length = read(watcher->notifyFd, buffer.bytes, sizeof(buffer.bytes));
+        if (length <= 0) break;
+        for (char* ptr = buffer.bytes; ptr < buffer.bytes + length;) {
+            const struct inotify_event* event = (const struct inotify_event*)ptr;
+            if (event->mask & IN_Q_OVERFLOW) matches = true;
+            if (event->len && strcmp(event->name, watcher->name) == 0) matches = true;
+            ptr += sizeof(struct inotify_event) + event->len;
+        }
     }
+    return matches;
+}
 
-    if (ZINI_FindSection(iniFile, section)) return true;
+static void* zini_watch_thread(void* arg) {
+    ZINI_Watcher* watcher = (ZINI_Watcher*)arg;
+    struct pollfd fds[2];
+    fds[0].fd = watcher->notifyFd;
+    fds[0].events = POLLIN;
+    fds[1].fd = watcher->stopPipe[0];
+    fds[1].events = POLLIN;
 
-    return false;
+    for (;;) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            perror("Failed to wait for file changes");
+            break;
+        }
+        if (fds[1].revents) break;
+        // all events queued so far are folded into one reload
+        if ((fds[0].revents & POLLIN) && zini_watch_matches(watcher)) zini_watch_reload(watcher);
+    }
+    return NULL;
 }
 
-bool ZINI_KeyExists(Section* section, const char* key) {
-    if (!section || !key) {
-        fprintf(stderr, "Section or key is NULL!\n");
-        return false;
-    }
-    for (int i = 0; i < section->pairCount; i++) {
-        if (strcmp(section->pairs[i].key, key) == 0) return true;
+ZINI_Watcher* ZINI_Watch(ZINI_Shared* shared, const char* path, ZINI_WatchCallback callback, void* context) {
+    if (!shared || !path) {
+        fprintf(stderr, "Shared INI file or path is NULL!\n");
+        return NULL;
     }
 
-    return false;
-}
+    ZINI_Watcher* watcher = (ZINI_Watcher*)calloc(1, sizeof(ZINI_Watcher));
+    char* directory = (char*)malloc(strlen(path) + 2);
+    if (watcher) watcher->path = (char*)malloc(strlen(path) + 1);
+    if (!watcher || !directory || !watcher->path) {
+        perror("Failed to allocate memory for watcher");
+        if (watcher) free(watcher->path);
+        free(watcher);
+        free(directory);
+        return NULL;
+    }
+    strcpy(watcher->path, path);
 
-void ZINI_Print(INIFILE* iniFile, FILE* stream) {
-    if (!stream || !iniFile) {
-        fprintf(stderr, "INI File or Stream is NULL!\n");
-        return;
+    const char* slash = strrchr(watcher->path, '/');
+    watcher->name = slash ? slash + 1 : watcher->path;
+    if (!slash) strcpy(directory, ".");
+    else if (slash == watcher->path) strcpy(directory, "/");
+    else {
+        memcpy(directory, watcher->path, (size_t)(slash - watcher->path));
+        directory[slash - watcher->path] = '\0';
     }
 
-    if (stream == stdout) fprintf(stream, "===================================\n");
+    watcher->shared = shared;
+    watcher->callback = callback;
+    watcher->context = context;
+    watcher->stopPipe[0] = watcher->stopPipe[1] = -1;
+    watcher->reader = ZINI_SharedRegister(shared);
+    watcher->notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
 
-    for (int i = 0; i < iniFile->sectionCount; i++) {
-        const Section* section = &iniFile->sections[i];
-        if (section->section[0] != '\0') {
-            fprintf(stream, "[%s]\n", section->section);
-            for (int j = 0; j < section->pairCount; j++) {
-                const Pair* pair = &section->pairs[j];
-                if (pair->key[0] != '\0' && pair->value[0] != '\0') {
-                    fprintf(stream, "%s=%s\n", pair->key, pair->value);
-                }
-            }
-            fprintf(stream, "\n");
-        }
+    bool ok = watcher->reader >= 0 && watcher->notifyFd >= 0 &&
+              inotify_add_watch(watcher->notifyFd, directory, IN_CLOSE_WRITE | IN_MOVED_TO) >= 0 &&
+              pipe(watcher->stopPipe) == 0 &&
+              pthread_create(&watcher->thread, NULL, zini_watch_thread, watcher) == 0;
+    free(directory);
+    if (!ok) {
+        perror("Failed to watch file");
+        if (watcher->reader >= 0) ZINI_SharedUnregister(shared, watcher->reader);
+        if (watcher->notifyFd >= 0) close(watcher->notifyFd);
+        if (watcher->stopPipe[0] >= 0) close(watcher->stopPipe[0]);
+        if (watcher->stopPipe[1] >= 0) close(watcher->stopPipe[1]);
+        free(watcher->path);
+        free(watcher);
+        return NULL;
     }
-    
-    if (stream == stdout) fprintf(stream, "===================================\n");
-}
\ No newline at end of file
+    return watcher;
+}
+
+void ZINI_Unwatch(ZINI_Watcher* watcher) {
+    if (!watcher) return;
+
+    char stop = 0;
+    while (write(watcher->stopPipe[1], &stop, 1) < 0 && errno == EINTR) {}
+    pthread_join(watcher->thread, NULL);
+
+    ZINI_SharedUnregister(watcher->shared, watcher->reader);
+    close(watcher->notifyFd);
+    close(watcher->stopPipe[0]);
+    close(watcher->stopPipe[1]);
+    free(watcher->path);
+    free(watcher);
+}
+#else
+struct INIWatcher {
+    int unused;
+};
+
+ZINI_Watcher* ZINI_Watch(ZINI_Shared* shared, const char* path, ZINI_WatchCallback callback, void* context) {
+    (void)shared;
+    (void)path;
+    (void)callback;
+    (void)context;
+    fprintf(stderr, "File watching is not supported on this platform!\n");
+    return NULL;
+}
+
+void ZINI_Unwatch(ZINI_Watcher* watcher) {
+    (void)watcher;
+}
+#endif // ZINI_HAVE_INOTIFY && ZINI_HAVE_PTHREADS
\ No newline at end of file
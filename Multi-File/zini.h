@@ -2,6 +2,7 @@
 #define ZINI_PARSER_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 
 
@@ -17,7 +18,23 @@
     #define MAX_VALUE_LENGTH 128
 #endif // MAX_VALUE_LENGTH
 
-#define MAX_LINE_LENGTH (MAX_KEY_LENGTH + MAX_VALUE_LENGTH + 2)
+// marks a section or INI file that has no recorded position in a file
+#define ZINI_NO_SOURCE ((size_t)-1)
+
+// sections with more pairs than this get a hash index, smaller ones are scanned linearly
+#ifndef ZINI_PAIR_INDEX_THRESHOLD
+    #define ZINI_PAIR_INDEX_THRESHOLD 8
+#endif // ZINI_PAIR_INDEX_THRESHOLD
+
+// number of threads that can be registered as readers of one ZINI_Shared at the same time
+#ifndef ZINI_SHARED_READERS
+    #define ZINI_SHARED_READERS 64
+#endif // ZINI_SHARED_READERS
+
+// initial size of the read window used by ZINI_Open and ZINI_Parse, it grows only for longer lines
+#ifndef ZINI_PARSE_WINDOW
+    #define ZINI_PARSE_WINDOW (64 * 1024)
+#endif // ZINI_PARSE_WINDOW
 
 #ifndef MAX_DOUBLE_PRECISION
     #define MAX_DOUBLE_PRECISION 2
@@ -41,7 +58,10 @@ typedef enum {
     ZINI_SECTION_NOT_FOUND,
     ZINI_MEMORY_ERROR,
     ZINI_INVALID_INPUT,
-    ZINI_FILE_ERROR
+    ZINI_FILE_ERROR,
+    ZINI_TYPE_ERROR,
+    ZINI_RANGE_ERROR,
+    ZINI_FROZEN_ERROR
 } ZINI_Status; // i'll add it later
 
 typedef enum {
@@ -55,36 +75,213 @@ typedef enum {
     ZINI_BOOL
 } ZINI_DType;
 
+/**
+ * How ZINI_AddPairVT writes ZINI_FLOAT and ZINI_DOUBLE values.
+ */
+typedef enum {
+    ZINI_FORMAT_FIXED,      /**< MAX_FLOAT_PRECISION or MAX_DOUBLE_PRECISION digits after the point, the default */
+    ZINI_FORMAT_SHORTEST    /**< Shortest text that reads back as exactly the same value */
+} ZINI_FloatFormat;
+
+
+/**
+ * One slot of an open-addressing hash index.
+ */
+typedef struct {
+    uint64_t hash;      /**< Hash of the indexed name */
+    size_t position;    /**< Array position of the entry plus one, 0 marks an empty slot */
+} ZINI_IndexSlot;
+
+/**
+ * Linear-probing hash index mapping names to positions in an array.
+ */
+typedef struct {
+    ZINI_IndexSlot* slots;  /**< Slot table, capacity is always a power of two */
+    size_t capacity;        /**< Number of slots */
+    size_t count;           /**< Number of occupied slots */
+} ZINI_Index;
+
+/**
+ * One slot of the (section, key) index, positions are stored plus one so 0 marks an empty slot.
+ */
+typedef struct {
+    uint64_t hash;      /**< Hash of the section name continued over the key, see ZINI_KeyHash */
+    uint32_t section;   /**< Position of the section plus one */
+    uint32_t pair;      /**< Position of the pair within its section */
+} ZINI_PathSlot;
+
+/**
+ * Linear-probing hash index mapping (section, key) pairs straight to the pair.
+ */
+typedef struct {
+    ZINI_PathSlot* slots;   /**< Slot table, capacity is always a power of two */
+    size_t capacity;        /**< Number of slots, 0 until the first lookup builds the index */
+    size_t count;           /**< Number of occupied slots */
+} ZINI_PathIndex;
+
+/**
+ * Identifies one version of a file on disk, so a save can tell whether the file is still the one it knows.
+ */
+typedef struct {
+    uint64_t device;    /**< Device holding the file, 0 with inode 0 when there is no file */
+    uint64_t inode;     /**< Inode of the file on its device */
+    int64_t modified;   /**< Last modification time in nanoseconds since the epoch */
+} ZINI_FileStamp;
+
+/**
+ * Kind of value held in the typed cache of a pair.
+ */
+typedef enum {
+    ZINI_CACHE_NONE,
+    ZINI_CACHE_INT,
+    ZINI_CACHE_DOUBLE,
+    ZINI_CACHE_BOOL
+} ZINI_CacheType;
 
 /**
  * Represents a key-value pair in an INI file.
  */
 typedef struct INIKeyValuePair {
-    char key[MAX_KEY_LENGTH];    /**< Key of the pair */
-    char value[MAX_VALUE_LENGTH]; /**< Value of the pair */
+    const char* key;      /**< Key of the pair, NUL-terminated */
+    const char* value;    /**< Value of the pair, NUL-terminated */
+    size_t keyLength;     /**< Length of the key in bytes */
+    size_t valueLength;   /**< Length of the value in bytes */
+    bool isModified;      /**< Set when the pair was added or changed since the last load or save */
+    ZINI_CacheType cacheType; /**< Kind of value in cache, ZINI_CACHE_NONE until a typed getter succeeds */
+    union {
+        int64_t asInt;
+        double asDouble;
+        bool asBool;
+    } cache;              /**< Value last converted by a typed getter, so repeated reads skip parsing */
 } Pair;
 
 /**
  * Represents a section in an INI file.
  */
 typedef struct INISection {
-    char section[MAX_SECTION_LENGTH];   /**< Name of the section */
+    const char* section;                /**< Name of the section, NUL-terminated */
+    size_t sectionLength;               /**< Length of the section name in bytes */
+    struct INIFile* owner;              /**< INI file the section belongs to, its string arena holds new pairs */
     Pair* pairs;                        /**< Array of key-value pairs in the section */
     size_t pairCount;                      /**< Number of key-value pairs in the section */
+    size_t pairCapacity;                /**< Number of pairs the pairs array can hold */
+    ZINI_Index pairIndex;               /**< Hash index over keys, empty until the section outgrows ZINI_PAIR_INDEX_THRESHOLD */
+    bool isModified;                    /**< Set when the section or any of its pairs changed since the last load or save */
+    size_t sourceOffset;                /**< Byte offset of the section header in its file, ZINI_NO_SOURCE if it has none */
+    size_t sourceLength;                /**< Length of the section in its file, from its header up to the next one */
 } Section;
 
+/**
+ * Block of the bump-allocated string arena owned by an INIFILE.
+ */
+typedef struct INIArenaBlock ZINI_ArenaBlock;
+
+/**
+ * Perfect hash lookup table of an INIFILE frozen by ZINI_Freeze.
+ */
+typedef struct INIFrozenIndex ZINI_FrozenIndex;
+
 /**
  * Represents an INI file, including all sections and their key-value pairs.
+ * Sections keep a pointer back to their INIFILE, so the structure must not be moved or copied by value
+ * once sections have been added.
  */
-typedef struct {
+typedef struct INIFile {
     Section* sections;    /**< Array of sections in the INI file */
     size_t sectionCount;     /**< Number of sections in the INI file */
+    size_t sectionCapacity;  /**< Number of sections the sections array can hold */
+    size_t pairReserve;      /**< Pair capacity given to newly added sections, see ZINI_Reserve */
     bool isModified;      /**< Flag indicating if the INI file has been modified */
+    ZINI_Index sectionIndex; /**< Hash index over section names */
+    ZINI_ArenaBlock* arena;  /**< String storage for section names, keys and values */
+    void* mapping;           /**< File mapping created by ZINI_OpenMapped, NULL otherwise */
+    size_t mappingLength;    /**< Length of the file mapping in bytes */
+    ZINI_FileStamp mappingFile; /**< File the mapping was made from, saves over it copy the strings out first */
+    size_t sourceSize;       /**< Size of the file the section offsets refer to, ZINI_NO_SOURCE if they refer to none */
+    ZINI_FileStamp sourceFile; /**< Version of the file the section offsets refer to, as last loaded or saved */
+    ZINI_FloatFormat floatFormat; /**< Format ZINI_AddPairVT uses for floating point values, set freely after ZINI_Init */
+    ZINI_FrozenIndex* frozen; /**< Lookup table built by ZINI_Freeze, NULL while the file can be modified */
+    ZINI_PathIndex pathIndex; /**< Index over all pairs for ZINI_Get, built by the first lookup and kept up to date after */
+    uint64_t generation;      /**< Bumped whenever pairs move or are removed, so a ZINI_Handle knows to resolve again */
+    size_t removedSource;     /**< Lowest source offset of a section removed since the last load or save, ZINI_NO_SOURCE if none */
 
     int maxSectionLength;
 } INIFILE;
 
 
+/**
+ * INI file shared between threads: readers look values up in the current version without locks while
+ * writers publish new versions, see ZINI_SharedCreate.
+ */
+typedef struct INIShared ZINI_Shared;
+
+/**
+ * Layered read-only view of several INI files, see ZINI_Overlay.
+ */
+typedef struct INIOverlay ZINI_OverlayView;
+
+/**
+ * Background thread reloading a ZINI_Shared from its file, see ZINI_Watch.
+ */
+typedef struct INIWatcher ZINI_Watcher;
+
+/**
+ * Kind of difference a ZINI_Change describes.
+ */
+typedef enum {
+    ZINI_CHANGE_ADDED,      /**< The key exists in the new version only */
+    ZINI_CHANGE_REMOVED,    /**< The key exists in the old version only */
+    ZINI_CHANGE_MODIFIED    /**< The key exists in both versions with different values */
+} ZINI_ChangeType;
+
+/**
+ * One (section, key) pair that differs between two versions of an INI file, or with no key, a section
+ * that was added, removed or had any of its pairs changed.
+ */
+typedef struct {
+    ZINI_ChangeType type;   /**< Kind of difference */
+    const char* section;    /**< Name of the section */
+    const char* key;        /**< Name of the key, NULL for a record about the whole section */
+    const char* oldValue;   /**< Value in the old version, NULL if the key was added */
+    const char* newValue;   /**< Value in the new version, NULL if the key was removed */
+} ZINI_Change;
+
+/**
+ * Growable array of changes filled by ZINI_Diff.
+ */
+typedef struct {
+    ZINI_Change* changes;   /**< Array of changes */
+    size_t count;           /**< Number of changes */
+    size_t capacity;        /**< Number of changes the array can hold */
+} ZINI_ChangeSet;
+
+/**
+ * Function ZINI_Watch calls after publishing a reloaded version. The changes and their strings are only
+ * valid during the call.
+ */
+typedef void (*ZINI_WatchCallback)(ZINI_Shared* shared, const ZINI_Change* changes, size_t count, void* context);
+
+/**
+ * Read-only view of a snapshot image created by ZINI_Compile.
+ */
+typedef struct {
+    const char* image;      /**< Snapshot image, NULL once closed */
+    size_t imageLength;     /**< Length of the image in bytes */
+    bool mapped;            /**< Set when the image is a file mapping rather than a heap copy */
+} ZINI_Snapshot;
+
+
+/**
+ * Event handlers for ZINI_Parse. Any handler may be NULL. Strings are NUL-terminated but only valid
+ * during the call, and returning false from a handler stops the parse.
+ */
+typedef struct {
+    bool (*onSection)(void* userdata, const char* section, size_t length);    /**< Called for every section header, repeated headers included */
+    bool (*onPair)(void* userdata, const char* key, size_t keyLength,
+                   const char* value, size_t valueLength);                   /**< Called for every key-value pair inside a section */
+    bool (*onComment)(void* userdata, const char* text, size_t length);       /**< Called for every comment line, text excludes the ';' */
+} ZINI_Callbacks;
+
 
 /**
  * Initializes an INI file structure.
@@ -100,6 +297,73 @@ void ZINI_Init(INIFILE *iniFile);
  */
 bool ZINI_Open(INIFILE* iniFile, const char* filename);
 
+/**
+ * Opens an INI file by mapping it into memory and parsing it in place. Sections and pairs point
+ * straight into the private mapping instead of being copied, and the mapping is released by ZINI_Clean.
+ * Keys and values are NUL-terminated in place, which dirties every page of the mapping: the kernel copies
+ * the whole file into private memory during the load, once and page by page, instead of each string
+ * being copied and allocated on its own. Memory use is therefore the file size, not the size of the data.
+ * Falls back to reading the whole file into memory on platforms without mmap. The file must not be
+ * rewritten in place by others while it is mapped, and saving over it with ZINI_Save or
+ * ZINI_SaveIncremental first copies the strings out of the mapping.
+ * @param iniFile Pointer to the INIFILE structure to be populated.
+ * @param filename Path to the INI file to be opened.
+ * @return True if the file was successfully mapped and parsed, false otherwise.
+ */
+bool ZINI_OpenMapped(INIFILE* iniFile, const char* filename);
+
+/**
+ * Opens an INI file like ZINI_OpenMapped, but splits the mapping at section headers and parses the
+ * pieces on several threads before merging them in file order. Repeated sections are merged and the
+ * first copy of a key wins, exactly as in ZINI_Open. Small files, and platforms without POSIX threads,
+ * are parsed on the calling thread.
+ * @param iniFile Pointer to the INIFILE structure to be populated.
+ * @param filename Path to the INI file to be opened.
+ * @param threads Number of threads to parse with.
+ * @return True if the file was successfully mapped and parsed, false otherwise.
+ */
+bool ZINI_OpenParallel(INIFILE* iniFile, const char* filename, int threads);
+
+/**
+ * Parses INI data held in memory. The data is copied once into the INIFILE's string storage,
+ * so the caller may release it as soon as the function returns.
+ * @param iniFile Pointer to the INIFILE structure to be populated.
+ * @param data INI text, does not need to be NUL-terminated.
+ * @param length Length of the data in bytes.
+ * @return True if the data was successfully parsed, false otherwise.
+ */
+bool ZINI_OpenBuffer(INIFILE* iniFile, const char* data, size_t length);
+
+/**
+ * Parses INI data held in memory without copying it. Sections and pairs point into the buffer, and
+ * delimiters and newlines in it are overwritten with NULs, so the buffer must stay alive and untouched
+ * until ZINI_Clean is called.
+ * @param iniFile Pointer to the INIFILE structure to be populated.
+ * @param data Writable INI text, does not need to be NUL-terminated.
+ * @param length Length of the data in bytes.
+ * @return True if the data was successfully parsed, false otherwise.
+ */
+bool ZINI_OpenBufferInPlace(INIFILE* iniFile, char* data, size_t length);
+
+/**
+ * Parses a NUL-terminated INI string, copying it like ZINI_OpenBuffer.
+ * @param iniFile Pointer to the INIFILE structure to be populated.
+ * @param data NUL-terminated INI text.
+ * @return True if the string was successfully parsed, false otherwise.
+ */
+bool ZINI_OpenString(INIFILE* iniFile, const char* data);
+
+/**
+ * Streams INI data from a file, calling the handlers as sections, pairs and comments are read, without
+ * building an INIFILE. Memory use is bounded by ZINI_PARSE_WINDOW or the longest line, whichever is
+ * larger. Accepts the same dialect as ZINI_Open.
+ * @param source Stream to read INI data from.
+ * @param callbacks Event handlers to be called.
+ * @param userdata Pointer passed through to every handler.
+ * @return True if the whole stream was parsed, false on a read error or when a handler stopped the parse.
+ */
+bool ZINI_Parse(FILE* source, const ZINI_Callbacks* callbacks, void* userdata);
+
 /**
  * Saves the current state of the INIFILE structure to an INI file.
  * @param iniFile Pointer to the INIFILE structure to be saved.
@@ -108,6 +372,105 @@ bool ZINI_Open(INIFILE* iniFile, const char* filename);
  */
 bool ZINI_Save(INIFILE* iniFile, const char* filename);
 
+/**
+ * Saves only what changed since the file was loaded or last saved. Sections that were not modified
+ * are left in place on disk, comments included. When every changed section keeps its size it is
+ * overwritten where it is, otherwise the file is rewritten from the first change onwards. Falls back
+ * to ZINI_Save when the file was not loaded from disk, repeats a section header, or filename is not the
+ * version last loaded or saved: another file, or the same one with a different size or modification time. The update happens in place and is not crash-safe, use ZINI_SaveAtomic for that.
+ * @param iniFile Pointer to the INIFILE structure to be saved.
+ * @param filename Path to the INI file it was loaded from or last saved to.
+ * @return True if the file was successfully updated, false otherwise.
+ */
+bool ZINI_SaveIncremental(INIFILE* iniFile, const char* filename);
+
+/**
+ * Saves the INIFILE so that readers and crashes only ever see the old or the new contents. The data is
+ * written to a temp file next to the target, synced, renamed over the target, and the directory is synced.
+ * On platforms without POSIX file semantics this behaves like ZINI_Save.
+ * @param iniFile Pointer to the INIFILE structure to be saved.
+ * @param filename Path to the INI file to be replaced.
+ * @return True if the file was durably replaced, false otherwise.
+ */
+bool ZINI_SaveAtomic(INIFILE* iniFile, const char* filename);
+
+/**
+ * Saves several INIFILEs atomically, like ZINI_SaveAtomic, but syncs each directory only once for the
+ * whole batch. All temp files are written before any target is replaced, so a write failure leaves every
+ * target untouched.
+ * @param iniFiles Array of INIFILE structures to be saved.
+ * @param filenames Array of target paths, one per INIFILE.
+ * @param count Number of files in the batch.
+ * @return True if every file was durably replaced, false otherwise.
+ */
+bool ZINI_SaveAtomicBatch(INIFILE** iniFiles, const char** filenames, size_t count);
+
+/**
+ * Writes a binary snapshot of the INIFILE that ZINI_OpenSnapshot can serve lookups from without parsing.
+ * The image holds the sections, pairs and strings plus a perfect hash over all (section, key) pairs, and
+ * is only readable on machines of the same byte order. The file is replaced atomically, so processes still
+ * reading an older snapshot of it are not disturbed.
+ * @param iniFile Pointer to the INIFILE structure to be compiled.
+ * @param filename Path of the snapshot file to be written.
+ * @return True if the snapshot was written, false otherwise.
+ */
+bool ZINI_Compile(INIFILE* iniFile, const char* filename);
+
+/**
+ * Opens a snapshot written by ZINI_Compile by mapping it read-only. Only the header is checked up front,
+ * so opening takes the same time whatever the size of the snapshot.
+ * @param snapshot Pointer to the ZINI_Snapshot structure to be populated.
+ * @param filename Path to the snapshot file.
+ * @return True if the snapshot was opened, false if it is missing, truncated or of another version.
+ */
+bool ZINI_OpenSnapshot(ZINI_Snapshot* snapshot, const char* filename);
+
+/**
+ * Finds the value of a key in a section of a snapshot, with one hash and one probe.
+ * @param snapshot Pointer to the opened snapshot.
+ * @param section Name of the section to search.
+ * @param key Key whose value is to be found.
+ * @return Value associated with the key, valid until the snapshot is closed, or NULL if not found.
+ */
+const char* ZINI_SnapshotGetValue(const ZINI_Snapshot* snapshot, const char* section, const char* key);
+
+/**
+ * Releases a snapshot opened by ZINI_OpenSnapshot.
+ * @param snapshot Pointer to the snapshot to be closed.
+ */
+void ZINI_CloseSnapshot(ZINI_Snapshot* snapshot);
+
+/**
+ * Freezes the INIFILE for read-heavy use. A perfect hash table is built over every (section, key) pair,
+ * so ZINI_GetValueEx and the typed Ex getters find a pair with a single probe instead of two index walks.
+ * Once frozen, adding, changing or removing sections and pairs fails, and the typed getters still use
+ * values cached before the freeze but no longer fill the cache, so a frozen file can be read from any
+ * number of threads. ZINI_Clean releases the table together with the rest of the file.
+ * @param iniFile Pointer to the INIFILE structure to be frozen.
+ * @return True if the file is frozen, including when it already was, false otherwise.
+ */
+bool ZINI_Freeze(INIFILE* iniFile);
+
+/**
+ * Preallocates room for sections and pairs, so callers who know the size of the data can
+ * avoid repeated reallocation while filling the INIFILE.
+ * @param iniFile Pointer to the INIFILE structure to be modified.
+ * @param sections Number of sections the INIFILE should hold without reallocating.
+ * @param pairsPerSection Number of pairs every existing and future section should hold without reallocating.
+ * @return True if the memory was reserved, false otherwise.
+ */
+bool ZINI_Reserve(INIFILE* iniFile, size_t sections, size_t pairsPerSection);
+
+/**
+ * Gives back memory a long-running INI file piled up through changes. Every live string is copied into
+ * one exactly sized arena block, dropping old values and removed keys and releasing a ZINI_OpenMapped
+ * mapping, and arrays and indexes are shrunk to their contents. All strings, sections and pairs obtained
+ * before become invalid, ZINI_Handle lookups resolve again by themselves.
+ * @param iniFile Pointer to the INIFILE structure to be compacted.
+ * @return True if the file was compacted, false if it is frozen or memory ran out, leaving it unchanged.
+ */
+bool ZINI_Compact(INIFILE* iniFile);
+
 /**
  * Adds a new section to the INIFILE structure.
  * @param iniFile Pointer to the INIFILE structure to be modified.
@@ -125,6 +488,15 @@ Section* ZINI_AddSection(INIFILE* iniFile, const char* section);
  */
 Pair* ZINI_AddPair(Section* section, const char* key, const char* value);
 
+/**
+ * Adds a new key-value pair to a section, formatting a typed value as text. Floating point values are
+ * written in the owning INIFILE's floatFormat.
+ * @param section Pointer to the Section structure to be modified.
+ * @param key Key of the pair to be added.
+ * @param value Pointer to the value, of the C type matching the data type.
+ * @param type Data type of the value.
+ * @return Pointer to the newly added Pair structure, or NULL if an error occurred.
+ */
 Pair* ZINI_AddPairVT(Section* section, const char* key, void* value, ZINI_DType type);
 
 Pair* ZINI_AddPairEx(INIFILE* iniFile, const char* section, const char* key, const char* value);
@@ -155,6 +527,152 @@ const char* ZINI_GetValue(Section* section, const char* key);
  */
 const char* ZINI_GetValueEx(INIFILE* iniFile, const char* section, const char* key); // will add a const char* section (for narrowing down the search)
 
+/**
+ * Finds a value by its "section.key" path in a single table probe. The first lookup builds an index over
+ * all pairs, which adding and removing pairs then keep current, and a frozen file uses its ZINI_Freeze
+ * table instead. Since section names may contain dots, the path is split at its last dot first and,
+ * if no such pair exists, at each earlier dot in turn.
+ * @param iniFile Pointer to the INIFILE structure to be searched.
+ * @param path Section name and key joined by a dot.
+ * @return Value associated with the key if found, NULL otherwise. Misses are not reported on stderr.
+ */
+const char* ZINI_Get(INIFILE* iniFile, const char* path);
+
+/**
+ * Same as ZINI_Get, with the section and the key given apart.
+ * @param iniFile Pointer to the INIFILE structure to be searched.
+ * @param section Name of the section holding the key.
+ * @param key Key whose value is to be found.
+ * @return Value associated with the key if found, NULL otherwise.
+ */
+const char* ZINI_Get2(INIFILE* iniFile, const char* section, const char* key);
+
+/**
+ * Lookup of one (section, key) pair resolved ahead of time by ZINI_Resolve, for values read over and over.
+ * The names are not copied, so they must outlive the handle; string literals are the usual case.
+ */
+typedef struct {
+    INIFILE* iniFile;       /**< INI file the handle reads from */
+    const char* section;    /**< Name of the section */
+    const char* key;        /**< Name of the key */
+    uint64_t hash;          /**< ZINI_KeyHash of the names, so resolving again skips hashing */
+    Pair* pair;             /**< Pair found by the last resolution, NULL if there was none */
+    uint64_t generation;    /**< Generation of the INI file when the pair was resolved */
+} ZINI_Handle;
+
+/**
+ * Resolves a (section, key) pair into a handle that ZINI_Read can read without hashing or comparing names.
+ * A key that does not exist yet can be resolved as well, ZINI_Read then looks for it on every read.
+ * @param iniFile Pointer to the INIFILE structure the handle reads from.
+ * @param section Name of the section, which must outlive the handle.
+ * @param key Name of the key, which must outlive the handle.
+ * @return Handle for the pair, with no INI file if an argument was NULL.
+ */
+ZINI_Handle ZINI_Resolve(INIFILE* iniFile, const char* section, const char* key);
+
+/**
+ * Reads the current value behind a handle. While the INI file keeps its generation this is a compare and
+ * a pointer read, and values updated by ZINI_SetValue show through. Once pairs have moved or been removed
+ * the handle resolves its names again first. Handles must not be used after ZINI_Clean.
+ * @param handle Pointer to a handle created by ZINI_Resolve.
+ * @return Value associated with the key, or NULL if the key does not exist.
+ */
+const char* ZINI_Read(ZINI_Handle* handle);
+
+/**
+ * Computes the hash ZINI_GetHashed looks a pair up by. It depends on the names only, so callers
+ * reading the same key over and over can compute it once, even before the file is loaded.
+ * @param section Name of the section.
+ * @param key Name of the key.
+ * @return Hash of the (section, key) pair.
+ */
+uint64_t ZINI_KeyHash(const char* section, const char* key);
+
+/**
+ * Same as ZINI_Get2, without hashing the names again.
+ * @param iniFile Pointer to the INIFILE structure to be searched.
+ * @param hash Value ZINI_KeyHash returned for section and key, any other value makes the lookup miss.
+ * @param section Name of the section holding the key.
+ * @param key Key whose value is to be found.
+ * @return Value associated with the key if found, NULL otherwise.
+ */
+const char* ZINI_GetHashed(INIFILE* iniFile, uint64_t hash, const char* section, const char* key);
+
+/**
+ * Reads the value of a key as an int. Like all typed getters it ignores blanks around the value,
+ * leaves *value untouched when it fails, and reports through its return value instead of stderr.
+ * Integers are decimal with an optional sign. The converted value is cached in the pair until the
+ * value changes, so typed getters write to the pair and must not race with other readers.
+ * @param section Pointer to the Section structure to be searched.
+ * @param key Key whose value is to be read.
+ * @param value Receives the converted value.
+ * @return ZINI_SUCCESS, ZINI_KEY_NOT_FOUND, ZINI_TYPE_ERROR if the value is not an integer,
+ *         ZINI_RANGE_ERROR if it does not fit, or ZINI_INVALID_INPUT for NULL arguments.
+ */
+ZINI_Status ZINI_GetInt(Section* section, const char* key, int* value);
+
+/**
+ * Reads the value of a key as a 64-bit integer, see ZINI_GetInt.
+ * @param section Pointer to the Section structure to be searched.
+ * @param key Key whose value is to be read.
+ * @param value Receives the converted value.
+ * @return ZINI_SUCCESS or the reason the value could not be read.
+ */
+ZINI_Status ZINI_GetInt64(Section* section, const char* key, int64_t* value);
+
+/**
+ * Reads the value of a key as an unsigned int, see ZINI_GetInt. Negative values are a range error.
+ * @param section Pointer to the Section structure to be searched.
+ * @param key Key whose value is to be read.
+ * @param value Receives the converted value.
+ * @return ZINI_SUCCESS or the reason the value could not be read.
+ */
+ZINI_Status ZINI_GetUInt(Section* section, const char* key, unsigned int* value);
+
+/**
+ * Reads the value of a key as a double, see ZINI_GetInt. Accepts decimal numbers with an optional
+ * fraction and exponent, and reports ZINI_RANGE_ERROR for values too large to represent.
+ * @param section Pointer to the Section structure to be searched.
+ * @param key Key whose value is to be read.
+ * @param value Receives the converted value.
+ * @return ZINI_SUCCESS or the reason the value could not be read.
+ */
+ZINI_Status ZINI_GetDouble(Section* section, const char* key, double* value);
+
+/**
+ * Reads the value of a key as a float, see ZINI_GetDouble.
+ * @param section Pointer to the Section structure to be searched.
+ * @param key Key whose value is to be read.
+ * @param value Receives the converted value.
+ * @return ZINI_SUCCESS or the reason the value could not be read.
+ */
+ZINI_Status ZINI_GetFloat(Section* section, const char* key, float* value);
+
+/**
+ * Reads the value of a key as a bool, see ZINI_GetInt. Accepts true/false, yes/no, on/off and 1/0
+ * in any case.
+ * @param section Pointer to the Section structure to be searched.
+ * @param key Key whose value is to be read.
+ * @param value Receives the converted value.
+ * @return ZINI_SUCCESS or the reason the value could not be read.
+ */
+ZINI_Status ZINI_GetBool(Section* section, const char* key, bool* value);
+
+/**
+ * Section-name variants of the typed getters, they additionally return ZINI_SECTION_NOT_FOUND.
+ */
+ZINI_Status ZINI_GetIntEx(INIFILE* iniFile, const char* section, const char* key, int* value);
+
+ZINI_Status ZINI_GetInt64Ex(INIFILE* iniFile, const char* section, const char* key, int64_t* value);
+
+ZINI_Status ZINI_GetUIntEx(INIFILE* iniFile, const char* section, const char* key, unsigned int* value);
+
+ZINI_Status ZINI_GetDoubleEx(INIFILE* iniFile, const char* section, const char* key, double* value);
+
+ZINI_Status ZINI_GetFloatEx(INIFILE* iniFile, const char* section, const char* key, float* value);
+
+ZINI_Status ZINI_GetBoolEx(INIFILE* iniFile, const char* section, const char* key, bool* value);
+
 /**
  * Cleans up and frees memory used by the INIFILE structure.
  * @param iniFile Pointer to the INIFILE structure to be cleaned.
@@ -168,9 +686,13 @@ void ZINI_Clean(INIFILE* iniFile);
  * @param key The key of the key-value pair to be removed.
  *
  * This function searches for the key in the section's key-value pairs and removes it if found.
- * Memory management for the removed key-value pair is handled within the function.
+ * The pairs behind it move down a place, keeping their order, so pointers to them become invalid.
+ * The strings of the removed pair stay in the arena until ZINI_Compact or ZINI_Clean.
+ *
+ * @return ZINI_SUCCESS if the pair was removed, ZINI_KEY_NOT_FOUND if the section has no such key,
+ *         ZINI_FROZEN_ERROR if the file is frozen, or ZINI_INVALID_INPUT for NULL arguments.
  */
-void ZINI_RemovePair(Section* section, const char* key);
+ZINI_Status ZINI_RemovePair(Section* section, const char* key);
 
 
 /**
@@ -182,8 +704,10 @@ void ZINI_RemovePair(Section* section, const char* key);
  *
  * This function locates the specified section within the INI file and then removes the key-value pair
  * from that section. Both the section and the key are required to be valid.
+ *
+ * @return The status of ZINI_RemovePair, or ZINI_SECTION_NOT_FOUND if the section does not exist.
  */
-void ZINI_RemovePairEx(INIFILE* iniFile, const char* section, const char* key);
+ZINI_Status ZINI_RemovePairEx(INIFILE* iniFile, const char* section, const char* key);
 
 
 /**
@@ -195,8 +719,12 @@ void ZINI_RemovePairEx(INIFILE* iniFile, const char* section, const char* key);
  *
  * This function searches for the key within the section's key-value pairs and updates its value if the
  * key is found. If the key does not exist, no changes are made.
+ *
+ * @return ZINI_SUCCESS if the value was updated, ZINI_KEY_NOT_FOUND if the section has no such key,
+ *         ZINI_MEMORY_ERROR if the new value could not be stored, ZINI_FROZEN_ERROR if the file is frozen,
+ *         or ZINI_INVALID_INPUT for NULL arguments.
  */
-void ZINI_SetValue(Section* section, const char* key, const char* newValue);
+ZINI_Status ZINI_SetValue(Section* section, const char* key, const char* newValue);
 
 
 /**
@@ -210,8 +738,10 @@ void ZINI_SetValue(Section* section, const char* key, const char* newValue);
  * This function locates the specified section within the INI file and updates the key's value within
  * that section. Both the section and the key are required to be valid. If the section or key does not exist,
  * no changes are made.
+ *
+ * @return The status of ZINI_SetValue, or ZINI_SECTION_NOT_FOUND if the section does not exist.
  */
-void ZINI_SetValueEx(INIFILE* iniFile, const char* section, const char* key, const char* newValue);
+ZINI_Status ZINI_SetValueEx(INIFILE* iniFile, const char* section, const char* key, const char* newValue);
 
 
 /**
@@ -221,9 +751,13 @@ void ZINI_SetValueEx(INIFILE* iniFile, const char* section, const char* key, con
  * @param section The name of the section to be removed.
  *
  * This function locates the specified section within the INI file and removes it along with its key-value
- * pairs. Memory allocated for the section and its pairs is freed.
+ * pairs. Memory allocated for the section and its pairs is freed, and the sections behind it move down a
+ * place, keeping their order, so pointers to them become invalid.
+ *
+ * @return ZINI_SUCCESS if the section was removed, ZINI_SECTION_NOT_FOUND if it does not exist,
+ *         ZINI_FROZEN_ERROR if the file is frozen, or ZINI_INVALID_INPUT for NULL arguments.
  */
-void ZINI_RemoveSection(INIFILE* iniFile, const char* section);
+ZINI_Status ZINI_RemoveSection(INIFILE* iniFile, const char* section);
 
 
 /**
@@ -264,4 +798,166 @@ bool ZINI_KeyExists(Section* section, const char* key);
 void ZINI_Print(INIFILE* iniFile, FILE* stream);
 
 
+/**
+ * Makes an independent, modifiable copy of an INI file, with its own copies of all strings. A frozen
+ * source gives an unfrozen copy. Only reads the source, so the version a ZINI_Shared reader holds can
+ * be cloned while other threads read it.
+ * @param source Pointer to the INIFILE structure to be copied.
+ * @param copy Pointer to the INIFILE structure to be initialized with the copy.
+ * @return True if the copy was made, false otherwise, leaving copy empty.
+ */
+bool ZINI_Clone(const INIFILE* source, INIFILE* copy);
+
+/**
+ * Creates a container that lets any number of threads read an INI file while writers replace it.
+ * Every version is frozen when published, so readers get single-probe lookups and nothing they hold
+ * changes under them. Readers never take a lock or wait on writers, and writers never wait on readers:
+ * a replaced version is freed once no reader is still inside it, at a later publish or when the
+ * container is destroyed.
+ * @param initial Pointer to the INIFILE structure holding the first version. Its contents are moved into
+ *                the container, leaving it empty, so it can live on the stack.
+ * @return Pointer to the new container, or NULL on failure, in which case initial is left untouched.
+ */
+ZINI_Shared* ZINI_SharedCreate(INIFILE* initial);
+
+/**
+ * Frees a container and every version it holds. No reader may be inside it.
+ * @param shared Pointer to the container to be destroyed.
+ */
+void ZINI_SharedDestroy(ZINI_Shared* shared);
+
+/**
+ * Registers the calling thread as a reader. Each reading thread registers once and passes its id to
+ * ZINI_SharedAcquire and ZINI_SharedRelease.
+ * @param shared Pointer to the container to be read.
+ * @return Reader id, or -1 if all ZINI_SHARED_READERS slots are taken.
+ */
+int ZINI_SharedRegister(ZINI_Shared* shared);
+
+/**
+ * Gives a reader slot back. The reader must not be inside the container.
+ * @param shared Pointer to the container.
+ * @param reader Id returned by ZINI_SharedRegister.
+ */
+void ZINI_SharedUnregister(ZINI_Shared* shared, int reader);
+
+/**
+ * Enters the container and returns its current version, which stays valid, with every string and pair
+ * read from it, until ZINI_SharedRelease. The version may only be looked up in, with the getters and
+ * ZINI_Get functions; calls do not nest.
+ * @param shared Pointer to the container.
+ * @param reader Id returned by ZINI_SharedRegister.
+ * @return Current version of the INI file, or NULL for an invalid reader id.
+ */
+INIFILE* ZINI_SharedAcquire(ZINI_Shared* shared, int reader);
+
+/**
+ * Leaves the container, after which the version returned by ZINI_SharedAcquire may be freed.
+ * @param shared Pointer to the container.
+ * @param reader Id returned by ZINI_SharedRegister.
+ */
+void ZINI_SharedRelease(ZINI_Shared* shared, int reader);
+
+/**
+ * Publishes a new version, which readers entering from now on get. Readers already inside keep the
+ * version they have.
+ * @param shared Pointer to the container.
+ * @param next Pointer to the INIFILE structure holding the new version, for example a ZINI_Clone of the
+ *             current one with changes applied. It is frozen and its contents are moved into the container,
+ *             leaving it empty.
+ * @return True if the version was published, false otherwise, in which case next is left unchanged.
+ */
+bool ZINI_SharedPublish(ZINI_Shared* shared, INIFILE* next);
+
+/**
+ * Changes the current version under the writer lock: clones it, hands the copy to edit and publishes
+ * the result, so concurrent writers cannot lose each other's changes.
+ * @param shared Pointer to the container.
+ * @param edit Function applying the changes, returning false to drop them.
+ * @param context Pointer passed on to edit.
+ * @return True if a new version was published, false otherwise.
+ */
+bool ZINI_SharedUpdate(ZINI_Shared* shared, bool (*edit)(INIFILE* copy, void* context), void* context);
+
+/**
+ * Compares two versions of an INI file. The records are grouped by section: a section record, with no
+ * key, comes first and is followed by the records of its pairs. Sections are listed in the order of the
+ * new version, then those only the old one has. Every pair of an added or removed section gets a record
+ * too, and a section both versions have is only listed if a pair in it differs. Each side is walked once
+ * and looked up in the other through the section and key indexes, so the cost is linear in the number of
+ * pairs. The records point at the strings of both files, which must stay unchanged while they are used.
+ * @param from Pointer to the old version.
+ * @param to Pointer to the new version.
+ * @param result Pointer to the change set to be filled, released with ZINI_FreeChangeSet.
+ * @return ZINI_SUCCESS, ZINI_MEMORY_ERROR if the records could not be stored, or ZINI_INVALID_INPUT
+ *         for NULL arguments.
+ */
+ZINI_Status ZINI_Diff(const INIFILE* from, const INIFILE* to, ZINI_ChangeSet* result);
+
+/**
+ * Releases the records of a change set filled by ZINI_Diff, leaving it empty.
+ * @param changes Pointer to the change set to be released.
+ */
+void ZINI_FreeChangeSet(ZINI_ChangeSet* changes);
+
+/**
+ * Layers INI files on top of each other, such as defaults, site and host settings, into a view where a
+ * key takes its value from the topmost layer that has it. A merged index over all layers is built once,
+ * so a lookup is one probe whatever the number of layers, and no pair is copied. The layers must not be
+ * changed or cleaned while the view is used; build a new view after changing one.
+ * @param layers Array of INI files, the base first and each later one overriding those before it.
+ * @param count Number of layers.
+ * @return Pointer to the view, released with ZINI_OverlayFree, or NULL on failure.
+ */
+ZINI_OverlayView* ZINI_Overlay(const INIFILE* const* layers, size_t count);
+
+/**
+ * Finds the value a key has in the topmost layer of a view that has it.
+ * @param view Pointer to the view to be searched.
+ * @param section Name of the section holding the key.
+ * @param key Key whose value is to be found.
+ * @return Value associated with the key if any layer has it, NULL otherwise.
+ */
+const char* ZINI_OverlayGet(const ZINI_OverlayView* view, const char* section, const char* key);
+
+/**
+ * Merges the layers of a view into one INI file holding only the winning pairs, with its arrays sized
+ * exactly. Sections keep the order they first appear in from the base up, and pairs within a section
+ * keep the order their keys first appear in. The result starts out unmodified.
+ * @param view Pointer to the view to be flattened.
+ * @param flat Pointer to the INIFILE structure to be initialized with the merged content.
+ * @return True if the file was built, false otherwise, leaving flat empty.
+ */
+bool ZINI_Flatten(const ZINI_OverlayView* view, INIFILE* flat);
+
+/**
+ * Frees a view created by ZINI_Overlay, leaving its layers untouched.
+ * @param view Pointer to the view to be freed.
+ */
+void ZINI_OverlayFree(ZINI_OverlayView* view);
+
+/**
+ * Watches an INI file and reloads it into a shared container whenever it is written or replaced, so
+ * processes pick up configuration changes without restarting. A background thread parses the new file,
+ * compares it with the current version and, if any pair differs, publishes it and calls the callback
+ * with the changed pairs. Files that fail to load or have gone missing by the time they are read are
+ * skipped and the current version stays.
+ * The directory holding the file is watched, so files replaced by renaming, as ZINI_SaveAtomic and most
+ * editors do, are picked up too. Files rewritten in place, as by ZINI_Save, are reloaded once closed.
+ * Only available where inotify is, NULL is returned elsewhere.
+ * @param shared Pointer to the container to publish new versions into, which must outlive the watcher.
+ * @param path Path to the INI file, copied by the watcher.
+ * @param callback Function called from the watcher thread after each publish, may be NULL.
+ * @param context Pointer passed on to the callback.
+ * @return Pointer to the watcher, or NULL on failure.
+ */
+ZINI_Watcher* ZINI_Watch(ZINI_Shared* shared, const char* path, ZINI_WatchCallback callback, void* context);
+
+/**
+ * Stops a watcher, waiting for a reload in progress to finish, and frees it.
+ * @param watcher Pointer to the watcher to be stopped.
+ */
+void ZINI_Unwatch(ZINI_Watcher* watcher);
+
+
 #endif // ZINI_PARSER_H
\ No newline at end of file